@@ -0,0 +1,835 @@
+#include "geo_batch.h"
+#include "json.h"
+#include "json_builder.h"
+#include "json_reader.h"
+#include "map_renderer.h"
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/resource.h>
+
+namespace {
+
+std::atomic<uint64_t> allocation_count = 0;
+std::atomic<uint64_t> allocated_bytes = 0;
+
+} // namespace
+
+// Заменяются все формы operator new и delete, включая массивы и выровненные: выделения любой
+// формы учитываются, и у каждой формы new есть парная замена delete
+namespace {
+
+void* CountedAllocate(size_t size, size_t alignment) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0) {
+        size = 1;
+    }
+    void* ptr = nullptr;
+    if (alignment <= alignof(std::max_align_t)) {
+        ptr = std::malloc(size);
+    } else {
+        // aligned_alloc требует размер, кратный выравниванию
+        ptr = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+    }
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // namespace
+
+void* operator new(size_t size) {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new[](size_t size) {
+    return CountedAllocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return CountedAllocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+namespace bench {
+
+struct NetworkSize {
+    std::string name;
+    size_t stops = 0;
+    size_t buses = 0;
+    size_t route_length = 0;
+};
+
+struct CaseResult {
+    std::string name;
+    double milliseconds = 0.0;
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+    long peak_rss_kb = 0;
+};
+
+long GetPeakRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <typename Func>
+CaseResult Measure(std::string name, Func func) {
+    const uint64_t allocations_before = allocation_count.load();
+    const uint64_t bytes_before = allocated_bytes.load();
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto finish = std::chrono::steady_clock::now();
+    return {std::move(name),
+            std::chrono::duration<double, std::milli>(finish - start).count(),
+            allocation_count.load() - allocations_before,
+            allocated_bytes.load() - bytes_before,
+            GetPeakRssKb()};
+}
+
+struct StopData {
+    std::string name;
+    geo::Coordinates coordinates;
+};
+
+struct BusData {
+    std::string name;
+    std::vector<size_t> stops;
+    bool is_roundtrip;
+};
+
+struct Network {
+    std::vector<StopData> stops;
+    std::vector<BusData> buses;
+    std::vector<std::tuple<size_t, size_t, int>> distances;
+};
+
+Network GenerateNetwork(const NetworkSize& size, std::mt19937& random) {
+    Network network;
+    std::uniform_real_distribution<double> lat(55.5, 55.9);
+    std::uniform_real_distribution<double> lng(37.3, 37.9);
+    for (size_t i = 0; i < size.stops; ++i) {
+        network.stops.push_back({"Stop " + std::to_string(i), {lat(random), lng(random)}});
+    }
+    std::uniform_int_distribution<size_t> stop_index(0, size.stops - 1);
+    std::uniform_int_distribution<int> distance(200, 3000);
+    for (size_t i = 0; i < size.buses; ++i) {
+        BusData bus{"Bus " + std::to_string(i), {}, i % 2 == 0};
+        for (size_t j = 0; j < size.route_length; ++j) {
+            bus.stops.push_back(stop_index(random));
+        }
+        if (bus.is_roundtrip) {
+            bus.stops.push_back(bus.stops.front());
+        }
+        for (size_t j = 1; j < bus.stops.size(); ++j) {
+            network.distances.emplace_back(bus.stops[j - 1], bus.stops[j], distance(random));
+        }
+        network.buses.push_back(std::move(bus));
+    }
+    return network;
+}
+
+std::string MakeBaseRequestsJson(const Network& network) {
+    std::vector<json::Dict> road_distances(network.stops.size());
+    for (const auto& [from, to, distance] : network.distances) {
+        road_distances[from][network.stops[to].name] = distance;
+    }
+    json::Array base_requests;
+    for (size_t i = 0; i < network.stops.size(); ++i) {
+        base_requests.emplace_back(json::Builder{}.StartDict()
+                .Key("type").Value("Stop")
+                .Key("name").Value(network.stops[i].name)
+                .Key("latitude").Value(network.stops[i].coordinates.lat)
+                .Key("longitude").Value(network.stops[i].coordinates.lng)
+                .Key("road_distances").Value(std::move(road_distances[i])).EndDict().Build());
+    }
+    for (const auto& bus : network.buses) {
+        json::Array stops;
+        for (const size_t stop : bus.stops) {
+            stops.emplace_back(network.stops[stop].name);
+        }
+        base_requests.emplace_back(json::Builder{}.StartDict()
+                .Key("type").Value("Bus")
+                .Key("name").Value(bus.name)
+                .Key("stops").Value(std::move(stops))
+                .Key("is_roundtrip").Value(bus.is_roundtrip).EndDict().Build());
+    }
+    std::ostringstream out;
+    json::Print(json::Document{json::Builder{}.StartDict().Key("base_requests").Value(std::move(base_requests)).EndDict().Build()}, out);
+    return out.str();
+}
+
+std::string MakeStatRequestsJson(const Network& network, size_t count) {
+    json::Array stat_requests;
+    for (size_t i = 0; i < count; ++i) {
+        const bool is_bus = i % 2 == 0;
+        stat_requests.emplace_back(json::Builder{}.StartDict()
+                .Key("id").Value(static_cast<int>(i))
+                .Key("type").Value(is_bus ? "Bus" : "Stop")
+                .Key("name").Value(is_bus ? network.buses[i % network.buses.size()].name : network.stops[i % network.stops.size()].name)
+                .EndDict().Build());
+    }
+    std::ostringstream out;
+    json::Print(json::Document{json::Builder{}.StartDict().Key("stat_requests").Value(std::move(stat_requests)).EndDict().Build()}, out);
+    return out.str();
+}
+
+renderer::RenderSettings MakeRenderSettings() {
+    renderer::RenderSettings settings;
+    settings.width = 1200;
+    settings.height = 1200;
+    settings.padding = 50;
+    settings.stop_radius = 5;
+    settings.line_width = 14;
+    settings.bus_label_font_size = 20;
+    settings.bus_label_offset = {7, 15};
+    settings.stop_label_font_size = 20;
+    settings.stop_label_offset = {7, -3};
+    settings.underlayer_color = svg::Rgba(255, 255, 255, 0.85);
+    settings.underlayer_width = 3;
+    settings.color_palette = {std::string("green"), svg::Rgb(255, 160, 0), std::string("red")};
+    return settings;
+}
+
+// Наибольшее относительное расхождение длины маршрута с geo::ComputeDistance
+using GeoErrors = std::vector<std::pair<std::string, double>>;
+
+std::vector<CaseResult> RunCases(const NetworkSize& size, const transport::TransportRouter::Settings& routing_settings, size_t route_queries, GeoErrors& geo_errors) {
+    std::mt19937 random(42);
+    const Network network = GenerateNetwork(size, random);
+    std::vector<CaseResult> results;
+
+    const std::string text = MakeBaseRequestsJson(network);
+    results.push_back(Measure("json::Load", [&text] {
+        std::istringstream input(text);
+        json::Load(input);
+    }));
+    // Много мелких словарей {"id", "type", "name"}, как в stat_requests
+    const std::string stat_text = MakeStatRequestsJson(network, route_queries);
+    results.push_back(Measure("json::Load stat_requests x" + std::to_string(route_queries), [&stat_text] {
+        std::istringstream input(stat_text);
+        json::Load(input);
+    }));
+    {
+        std::istringstream input(text);
+        const JsonReader reader(input);
+        const auto usage = reader.GetDocumentMemoryUsage();
+        std::cout << "json DOM of base_requests: " << usage.bytes << " bytes in " << usage.allocations
+                  << " allocations, sizeof(json::Node) = " << sizeof(json::Node) << '\n';
+    }
+
+    transport::Catalogue catalogue;
+    for (const auto& stop : network.stops) {
+        catalogue.AddStop(stop.name, stop.coordinates);
+    }
+    std::vector<const transport::Stop*> stop_ptrs;
+    for (const auto& stop : network.stops) {
+        stop_ptrs.push_back(catalogue.FindStop(stop.name));
+    }
+    for (const auto& [from, to, distance] : network.distances) {
+        catalogue.SetStopDistance(stop_ptrs[from], stop_ptrs[to], distance);
+    }
+    results.push_back(Measure("Catalogue::AddBus", [&] {
+        for (const auto& bus : network.buses) {
+            std::vector<const transport::Stop*> stops;
+            for (const size_t stop : bus.stops) {
+                stops.push_back(stop_ptrs[stop]);
+            }
+            catalogue.AddBus(bus.name, stops, bus.is_roundtrip);
+        }
+    }));
+    results.push_back(Measure("Catalogue::BuildIndexes", [&] {
+        catalogue.BuildIndexes();
+    }));
+
+    results.push_back(Measure("Catalogue::GetStopDistance", [&] {
+        int64_t total = 0;
+        for (const auto& [from, to, _] : network.distances) {
+            total += catalogue.GetStopDistance(stop_ptrs[from], stop_ptrs[to]);
+            total += catalogue.GetStopDistance(stop_ptrs[to], stop_ptrs[from]);
+        }
+        if (total < 0) {
+            std::cerr << total;
+        }
+    }));
+
+    std::unique_ptr<transport::TransportRouter> router;
+    results.push_back(Measure("TransportRouter::TransportRouter", [&] {
+        router = std::make_unique<transport::TransportRouter>(routing_settings, catalogue);
+    }));
+
+    std::uniform_int_distribution<size_t> stop_index(0, size.stops - 1);
+    std::vector<std::pair<const transport::Stop*, const transport::Stop*>> queries;
+    for (size_t i = 0; i < route_queries; ++i) {
+        queries.emplace_back(stop_ptrs[stop_index(random)], stop_ptrs[stop_index(random)]);
+    }
+    results.push_back(Measure("Router::BuildRoute x" + std::to_string(route_queries), [&] {
+        for (const auto& [from, to] : queries) {
+            router->FindRoute(from, to);
+        }
+    }));
+
+    results.push_back(Measure("FindParetoRoutes x" + std::to_string(route_queries), [&] {
+        for (const auto& [from, to] : queries) {
+            router->FindParetoRoutes(from, to);
+        }
+    }));
+
+    // Расписание по умолчанию: рейсы весь день с интервалом 2 * bus_wait_time
+    std::unique_ptr<transport::TimetableRouter> timetable;
+    results.push_back(Measure("TimetableRouter::TimetableRouter", [&] {
+        timetable = std::make_unique<transport::TimetableRouter>(
+            transport::TimetableRouter::Settings{routing_settings.bus_wait_time, routing_settings.bus_velocity}, catalogue);
+    }));
+    std::uniform_real_distribution<double> departure_time(300.0, 1200.0);
+    std::vector<std::tuple<const transport::Stop*, const transport::Stop*, double>> timetable_queries;
+    for (const auto& [from, to] : queries) {
+        timetable_queries.emplace_back(from, to, departure_time(random));
+    }
+    results.push_back(Measure("FindEarliestArrival x" + std::to_string(route_queries), [&] {
+        for (const auto& [from, to, time] : timetable_queries) {
+            timetable->FindEarliestArrival(from, to, time);
+        }
+    }));
+
+    // Длины всех маршрутов, как в GetBusStat; повторяем, чтобы время было измеримым
+    constexpr int GEO_REPEATS = 100;
+    std::vector<std::vector<uint32_t>> paths;
+    for (const auto& bus : network.buses) {
+        std::vector<uint32_t> path;
+        for (const size_t stop : bus.stops) {
+            path.push_back(stop_ptrs[stop]->id);
+        }
+        paths.push_back(std::move(path));
+    }
+    std::vector<double> scalar_lengths(paths.size());
+    results.push_back(Measure("geo::ComputeDistance x" + std::to_string(GEO_REPEATS), [&] {
+        for (int repeat = 0; repeat < GEO_REPEATS; ++repeat) {
+            for (size_t i = 0; i < paths.size(); ++i) {
+                double length = 0;
+                for (size_t j = 1; j < paths[i].size(); ++j) {
+                    length += geo::ComputeDistance(network.stops[network.buses[i].stops[j - 1]].coordinates,
+                                                   network.stops[network.buses[i].stops[j]].coordinates);
+                }
+                scalar_lengths[i] = length;
+            }
+        }
+    }));
+    for (const auto& [formula, name] : {std::pair{geo::DistanceFormula::COSINES, "cosines"}, std::pair{geo::DistanceFormula::HAVERSINE, "haversine"}}) {
+        std::vector<double> batch_lengths(paths.size());
+        results.push_back(Measure(std::string("geo::ComputePathLength ") + name + " x" + std::to_string(GEO_REPEATS), [&] {
+            for (int repeat = 0; repeat < GEO_REPEATS; ++repeat) {
+                for (size_t i = 0; i < paths.size(); ++i) {
+                    batch_lengths[i] = geo::ComputePathLength(catalogue.GetStopVectors(), paths[i], formula);
+                }
+            }
+        }));
+        double max_error = 0;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            max_error = std::max(max_error, std::abs(batch_lengths[i] - scalar_lengths[i]) / scalar_lengths[i]);
+        }
+        geo_errors.emplace_back(name, max_error);
+    }
+
+    const renderer::MapRenderer map_renderer(MakeRenderSettings());
+    svg::Document map;
+    results.push_back(Measure("MapRenderer::RenderMap", [&] {
+        map = map_renderer.RenderMap(catalogue.GetSortedBuses());
+    }));
+
+    results.push_back(Measure("svg::Document::Render", [&] {
+        std::ostringstream out;
+        map.Render(out);
+    }));
+
+    // Ответ на запрос Map: одна длинная строка SVG с кавычками и переводами строк
+    std::ostringstream svg_text;
+    map.Render(svg_text);
+    const json::Document map_response{json::Builder{}.StartArray().StartDict()
+        .Key("map").Value(svg_text.str())
+        .Key("request_id").Value(1)
+        .EndDict().EndArray().Build()};
+    results.push_back(Measure("json::Print Map response", [&map_response] {
+        std::ostringstream out;
+        json::Print(map_response, out);
+    }));
+    std::istringstream base_input(text);
+    const json::Document base_document = json::Load(base_input);
+    results.push_back(Measure("json::Print base_requests", [&base_document] {
+        std::ostringstream out;
+        json::Print(base_document, out);
+    }));
+
+    return results;
+}
+
+// Пространственный и префиксный индексы на большом числе остановок; перебор для сравнения выполняется на сотой части запросов
+std::vector<CaseResult> RunSpatialCases(size_t stop_count, size_t queries) {
+    std::mt19937 random(7);
+    std::uniform_real_distribution<double> lat(55.5, 55.9);
+    std::uniform_real_distribution<double> lng(37.3, 37.9);
+    std::vector<CaseResult> results;
+
+    transport::Catalogue catalogue;
+    for (size_t i = 0; i < stop_count; ++i) {
+        catalogue.AddStop("Stop " + std::to_string(i), {lat(random), lng(random)});
+    }
+    results.push_back(Measure("Catalogue::BuildIndexes", [&] {
+        catalogue.BuildIndexes();
+    }));
+    const auto& index = catalogue.GetSpatialIndex();
+
+    std::vector<geo::Coordinates> centers;
+    for (size_t i = 0; i < queries; ++i) {
+        centers.push_back({lat(random), lng(random)});
+    }
+    size_t found = 0;
+    results.push_back(Measure("FindNearest k=10 x" + std::to_string(queries), [&] {
+        for (const auto& center : centers) {
+            found += index.FindNearest(center, 10, std::nullopt).size();
+        }
+    }));
+    results.push_back(Measure("FindNearest r=300m x" + std::to_string(queries), [&] {
+        for (const auto& center : centers) {
+            found += index.FindNearest(center, std::nullopt, 300.0).size();
+        }
+    }));
+    results.push_back(Measure("FindInArea 0.01x0.01 deg x" + std::to_string(queries), [&] {
+        for (const auto& center : centers) {
+            found += index.FindInArea(center, {center.lat + 0.01, center.lng + 0.01}).size();
+        }
+    }));
+
+    std::vector<std::string> prefixes;
+    for (size_t i = 0; i < queries; ++i) {
+        prefixes.push_back("stop " + std::to_string(i % 1000));
+    }
+    results.push_back(Measure("NamePrefixIndex::FindByPrefix x" + std::to_string(queries), [&] {
+        for (const auto& prefix : prefixes) {
+            found += catalogue.GetNameIndex().FindByPrefix(prefix, 10).size();
+        }
+    }));
+
+    std::vector<const transport::Stop*> stops;
+    for (size_t i = 0; i < stop_count; ++i) {
+        stops.push_back(catalogue.FindStop("Stop " + std::to_string(i)));
+    }
+    const size_t brute_force_queries = std::max<size_t>(queries / 100, 1);
+    results.push_back(Measure("brute force nearest x" + std::to_string(brute_force_queries), [&] {
+        for (size_t i = 0; i < brute_force_queries; ++i) {
+            const transport::Stop* nearest = nullptr;
+            double best = std::numeric_limits<double>::infinity();
+            for (const auto* stop : stops) {
+                const double distance = geo::ComputeDistance(centers[i], stop->coordinates);
+                if (distance < best) {
+                    best = distance;
+                    nearest = stop;
+                }
+            }
+            found += nearest != nullptr;
+        }
+    }));
+    if (found == 0) {
+        std::cerr << found;
+    }
+    return results;
+}
+
+void FillCatalogue(const Network& network, transport::Catalogue& catalogue) {
+    for (const auto& stop : network.stops) {
+        catalogue.AddStop(stop.name, stop.coordinates);
+    }
+    std::vector<const transport::Stop*> stop_ptrs;
+    for (const auto& stop : network.stops) {
+        stop_ptrs.push_back(catalogue.FindStop(stop.name));
+    }
+    for (const auto& [from, to, distance] : network.distances) {
+        catalogue.SetStopDistance(stop_ptrs[from], stop_ptrs[to], distance);
+    }
+    for (const auto& bus : network.buses) {
+        std::vector<const transport::Stop*> stops;
+        for (const size_t stop : bus.stops) {
+            stops.push_back(stop_ptrs[stop]);
+        }
+        catalogue.AddBus(bus.name, stops, bus.is_roundtrip);
+    }
+    catalogue.BuildIndexes();
+}
+
+// Предрасчёт всех пар классическим и блочным Флойдом–Уоршеллом на одном графе при удвоении числа вершин
+// до max_vertices; достижимость и веса маршрутов обоих вариантов сравниваются по всем парам
+std::vector<CaseResult> RunAllPairsCases(size_t max_vertices) {
+    std::vector<CaseResult> results;
+    size_t mismatches = 0;
+    double max_difference = 0.0;
+    for (size_t vertex_count = 128; vertex_count <= max_vertices; vertex_count *= 2) {
+        const size_t stop_count = vertex_count / 2;
+        std::mt19937 random(42);
+        const Network network = GenerateNetwork({"all_pairs", stop_count, std::max<size_t>(stop_count / 10, 1), 10}, random);
+        transport::Catalogue catalogue;
+        FillCatalogue(network, catalogue);
+        transport::TransportRouter::Settings settings{6, 40.0};
+        settings.all_pairs_algorithm = transport::AllPairsAlgorithm::BLOCKED;
+        const transport::TransportRouter transport_router(settings, catalogue);
+        const auto& graph = transport_router.GetGraph();
+
+        const std::string suffix = " V=" + std::to_string(graph.GetVertexCount());
+        std::unique_ptr<transport::RouteRouter> classic;
+        results.push_back(Measure("all pairs classic" + suffix, [&] {
+            classic = std::make_unique<transport::RouteRouter>(graph, graph::RoutingMode::ALL_PAIRS);
+        }));
+        std::unique_ptr<transport::RouteRouter> blocked;
+        results.push_back(Measure("all pairs blocked" + suffix, [&] {
+            blocked = std::make_unique<transport::RouteRouter>(graph, graph::RoutingMode::ALL_PAIRS_BLOCKED);
+        }));
+        for (transport::RouteId from = 0; from < graph.GetVertexCount(); ++from) {
+            for (transport::RouteId to = 0; to < graph.GetVertexCount(); ++to) {
+                const auto classic_weight = classic->GetRouteWeight(from, to);
+                const auto blocked_weight = blocked->GetRouteWeight(from, to);
+                if (classic_weight.has_value() != blocked_weight.has_value()) {
+                    ++mismatches;
+                } else if (classic_weight) {
+                    max_difference = std::max(max_difference, std::abs(transport::ToMinutes(*classic_weight) - transport::ToMinutes(*blocked_weight)));
+                }
+            }
+        }
+    }
+    std::cout << "all pairs reachability mismatches: " << mismatches
+              << ", max route weight difference: " << max_difference << '\n';
+    return results;
+}
+
+// Граф маршрутов в другом представлении; веса пересчитываются из минут, для целых — с округлением
+template <typename Weight, typename Id>
+graph::DirectedWeightedGraph<Weight, Id> ConvertGraph(const transport::RouteGraph& source, double per_minute) {
+    graph::DirectedWeightedGraph<Weight, Id> result(source.GetVertexCount());
+    for (transport::RouteId edge_id = 0; edge_id < source.GetEdgeCount(); ++edge_id) {
+        const auto& edge = source.GetEdge(edge_id);
+        const double weight = transport::ToMinutes(edge.weight) * per_minute;
+        result.AddEdge({edge.type, static_cast<Id>(edge.from), static_cast<Id>(edge.to),
+                        static_cast<Weight>(std::is_integral_v<Weight> ? std::round(weight) : weight)});
+    }
+    return result;
+}
+
+// Построение маршрутизатора и ответы на запросы для одного представления весов и номеров;
+// веса найденных маршрутов в минутах складываются в weights для сравнения с double
+template <typename Weight, typename Id>
+void MeasureRepresentation(const std::string& name, const transport::RouteGraph& source, double per_minute,
+                           graph::RoutingMode mode, const std::vector<std::pair<transport::RouteId, transport::RouteId>>& queries,
+                           std::vector<CaseResult>& results, std::vector<std::optional<double>>& weights) {
+    const auto graph = ConvertGraph<Weight, Id>(source, per_minute);
+    std::unique_ptr<graph::Router<Weight, Id>> router;
+    results.push_back(Measure(name + " Router", [&] {
+        router = std::make_unique<graph::Router<Weight, Id>>(graph, mode);
+    }));
+    weights.clear();
+    results.push_back(Measure(name + " BuildRoute x" + std::to_string(queries.size()), [&] {
+        for (const auto& [from, to] : queries) {
+            const auto route = router->BuildRoute(static_cast<Id>(from), static_cast<Id>(to));
+            weights.push_back(route ? std::optional<double>(static_cast<double>(route->weight) / per_minute) : std::nullopt);
+        }
+    }));
+}
+
+// Один и тот же граф маршрутов в представлениях double/size_t, float/uint32_t и целых децисекунд
+// с uint32_t: время и память построения маршрутизатора и запросов, расхождение весов с double
+std::vector<CaseResult> RunRepresentationCases(const NetworkSize& size, const transport::TransportRouter::Settings& routing_settings,
+                                               size_t route_queries) {
+    std::mt19937 random(42);
+    const Network network = GenerateNetwork(size, random);
+    transport::Catalogue catalogue;
+    FillCatalogue(network, catalogue);
+    const transport::TransportRouter transport_router(routing_settings, catalogue);
+    const auto mode = routing_settings.graph_model == transport::GraphModel::CHAINED
+        ? graph::RoutingMode::ON_DEMAND
+        : graph::RoutingMode::ALL_PAIRS;
+
+    std::uniform_int_distribution<size_t> stop_index(0, size.stops - 1);
+    std::vector<std::pair<transport::RouteId, transport::RouteId>> queries;
+    for (size_t i = 0; i < route_queries; ++i) {
+        queries.emplace_back(*transport_router.GetStopId(network.stops[stop_index(random)].name),
+                             *transport_router.GetStopId(network.stops[stop_index(random)].name));
+    }
+
+    std::vector<CaseResult> results;
+    std::vector<std::optional<double>> reference;
+    std::vector<std::optional<double>> weights;
+    const auto& source = transport_router.GetGraph();
+    MeasureRepresentation<double, size_t>("double/size_t", source, 1.0, mode, queries, results, reference);
+    const auto compare = [&reference, &weights](const std::string& name) {
+        size_t mismatches = 0;
+        double max_difference = 0.0;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            if (reference[i].has_value() != weights[i].has_value()) {
+                ++mismatches;
+            } else if (reference[i]) {
+                max_difference = std::max(max_difference, std::abs(*reference[i] - *weights[i]));
+            }
+        }
+        std::cout << name << " reachability mismatches: " << mismatches
+                  << ", max route weight difference, min: " << max_difference << '\n';
+    };
+    MeasureRepresentation<float, uint32_t>("float/uint32_t", source, 1.0, mode, queries, results, weights);
+    compare("float/uint32_t");
+    MeasureRepresentation<uint32_t, uint32_t>("decisec/uint32_t", source, 600.0, mode, queries, results, weights);
+    compare("decisec/uint32_t");
+    return results;
+}
+
+// Поток мелких запросов Stop, Bus и Route поровну
+std::string MakeMixedStatRequestsJson(const Network& network, size_t count, std::mt19937& random) {
+    std::uniform_int_distribution<size_t> stop_index(0, network.stops.size() - 1);
+    std::uniform_int_distribution<size_t> bus_index(0, network.buses.size() - 1);
+    json::Array stat_requests;
+    for (size_t i = 0; i < count; ++i) {
+        json::Builder request;
+        request.StartDict().Key("id").Value(static_cast<int>(i));
+        if (i % 3 == 0) {
+            request.Key("type").Value("Stop").Key("name").Value(network.stops[stop_index(random)].name);
+        } else if (i % 3 == 1) {
+            request.Key("type").Value("Bus").Key("name").Value(network.buses[bus_index(random)].name);
+        } else {
+            request.Key("type").Value("Route")
+                .Key("from").Value(network.stops[stop_index(random)].name)
+                .Key("to").Value(network.stops[stop_index(random)].name);
+        }
+        stat_requests.emplace_back(request.EndDict().Build());
+    }
+    std::ostringstream out;
+    json::Print(json::Document{json::Builder{}.StartDict().Key("stat_requests").Value(std::move(stat_requests)).EndDict().Build()}, out);
+    return out.str();
+}
+
+// Один поток запросов Stop/Bus/Route в JSON и в двоичном протоколе: байты запросов и ответов
+// и время на запрос — полный цикл (разбор, обработка, вывод) и только кодек (без обработки)
+std::vector<CaseResult> RunWireCases(const NetworkSize& size, const transport::TransportRouter::Settings& routing_settings,
+                                     size_t queries) {
+    std::mt19937 random(42);
+    const Network network = GenerateNetwork(size, random);
+    transport::Catalogue catalogue;
+    FillCatalogue(network, catalogue);
+    const transport::TransportRouter transport_router(routing_settings, catalogue);
+    const renderer::MapRenderer map_renderer(MakeRenderSettings());
+    RequestHandler handler(catalogue, map_renderer, transport_router);
+
+    const std::string json_requests = MakeMixedStatRequestsJson(network, queries, random);
+    std::istringstream reader_input(json_requests);
+    const JsonReader reader(reader_input);
+    const std::vector<StatRequest> requests = reader.DecodeStatRequests(reader.GetStatRequests().AsArray(), handler);
+    // Первый проход заполняет кэш маршрутов, чтобы оба протокола отвечали из него
+    json::Array responses;
+    for (const auto& request : requests) {
+        responses.push_back(reader.HandleStatRequest(request, handler));
+    }
+    std::ostringstream binary_out;
+    std::string payload;
+    for (const auto& request : requests) {
+        payload.clear();
+        wire::EncodeStatRequest(request, payload);
+        wire::WriteFrame(binary_out, payload);
+    }
+    const std::string binary_requests = binary_out.str();
+
+    std::vector<CaseResult> results;
+    size_t json_response_bytes = 0;
+    std::string binary_responses;
+    results.push_back(Measure("JSON parse+handle+print", [&] {
+        std::istringstream input(json_requests);
+        const JsonReader json_reader(input);
+        json::Array result;
+        for (const auto& request : json_reader.DecodeStatRequests(json_reader.GetStatRequests().AsArray(), handler)) {
+            result.push_back(json_reader.HandleStatRequest(request, handler));
+        }
+        std::ostringstream out;
+        json::Print(json::Document{std::move(result)}, out);
+        json_response_bytes = out.str().size();
+    }));
+    results.push_back(Measure("binary decode+handle+encode", [&] {
+        std::istringstream input(binary_requests);
+        std::ostringstream out;
+        wire::ServeStatRequests(input, out, reader, handler);
+        binary_responses = out.str();
+    }));
+    const json::Document response_document{responses};
+    results.push_back(Measure("JSON codec only", [&] {
+        std::istringstream input(json_requests);
+        const JsonReader json_reader(input);
+        json_reader.DecodeStatRequests(json_reader.GetStatRequests().AsArray(), handler);
+        std::ostringstream out;
+        json::Print(response_document, out);
+    }));
+    results.push_back(Measure("binary codec only", [&] {
+        std::istringstream input(binary_requests);
+        std::ostringstream out;
+        std::string request_payload;
+        std::string response_payload;
+        for (const auto& response : responses) {
+            wire::ReadFrame(input, request_payload);
+            wire::DecodeStatRequest(request_payload, handler);
+            response_payload.clear();
+            wire::EncodeResponse(response, response_payload);
+            wire::WriteFrame(out, response_payload);
+        }
+    }));
+
+    const double count = static_cast<double>(queries);
+    std::cout << std::fixed << std::setprecision(1)
+              << "wire bytes per request: JSON " << json_requests.size() / count << " in, " << json_response_bytes / count
+              << " out; binary " << binary_requests.size() / count << " in, " << binary_responses.size() / count << " out\n";
+    // Ответы двоичного протокола после расшифровки должны совпадать с ответами JSON
+    size_t mismatches = 0;
+    std::istringstream binary_input(binary_responses);
+    for (const auto& response : responses) {
+        if (!wire::ReadFrame(binary_input, payload) || !(wire::DecodeResponse(payload) == response)) {
+            ++mismatches;
+        }
+    }
+    std::cout << "binary responses differing from JSON: " << mismatches << '\n';
+    for (const auto& result : results) {
+        std::cout << result.name << ": " << std::setprecision(3) << result.milliseconds * 1000.0 / count << " us per request\n";
+    }
+    return results;
+}
+
+void PrintResults(const NetworkSize& size, const std::vector<CaseResult>& results, const GeoErrors& geo_errors) {
+    std::cout << "== " << size.name << ": stops=" << size.stops << " buses=" << size.buses
+              << " route_length=" << size.route_length << '\n';
+    std::cout << std::left << std::setw(36) << "case" << std::right
+              << std::setw(14) << "time, ms" << std::setw(14) << "allocs"
+              << std::setw(16) << "alloc bytes" << std::setw(16) << "peak rss, KB" << '\n';
+    for (const auto& result : results) {
+        std::cout << std::left << std::setw(36) << result.name << std::right
+                  << std::setw(14) << std::fixed << std::setprecision(3) << result.milliseconds
+                  << std::setw(14) << result.allocations
+                  << std::setw(16) << result.bytes
+                  << std::setw(16) << result.peak_rss_kb << '\n';
+    }
+    for (const auto& [name, error] : geo_errors) {
+        std::cout << "geo " << name << " max relative difference from ComputeDistance: " << std::scientific << std::setprecision(2) << error << std::fixed << '\n';
+    }
+}
+
+} // namespace bench
+
+// Использование: benchmark [stops buses route_length] [--chained] [--queries N] [--spatial STOPS] [--all-pairs MAX_VERTICES] [--representations] [--wire]
+int main(int argc, char* argv[]) {
+    std::vector<bench::NetworkSize> sizes = {
+        {"small", 100, 10, 10},
+        {"medium", 400, 40, 20},
+        {"large", 800, 80, 30},
+    };
+    transport::TransportRouter::Settings routing_settings{6, 40.0};
+    size_t route_queries = 1000;
+    size_t spatial_stops = 0;
+    size_t all_pairs_vertices = 0;
+    bool representations = false;
+    bool wire_protocol = false;
+    std::vector<size_t> custom_size;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--chained") {
+            routing_settings.graph_model = transport::GraphModel::CHAINED;
+        } else if (arg == "--queries" && i + 1 < argc) {
+            route_queries = std::stoul(argv[++i]);
+        } else if (arg == "--spatial" && i + 1 < argc) {
+            spatial_stops = std::stoul(argv[++i]);
+        } else if (arg == "--all-pairs" && i + 1 < argc) {
+            all_pairs_vertices = std::stoul(argv[++i]);
+        } else if (arg == "--representations") {
+            representations = true;
+        } else if (arg == "--wire") {
+            wire_protocol = true;
+        } else {
+            custom_size.push_back(std::stoul(arg));
+        }
+    }
+    if (custom_size.size() == 3 && custom_size[0] > 0) {
+        sizes = {{"custom", custom_size[0], custom_size[1], custom_size[2]}};
+    } else if (!custom_size.empty()) {
+        std::cerr << "Usage: benchmark [stops buses route_length] [--chained] [--queries N] [--spatial STOPS] [--all-pairs MAX_VERTICES] [--representations] [--wire]" << std::endl;
+        return 1;
+    }
+    if (spatial_stops > 0) {
+        bench::PrintResults({"spatial", spatial_stops, 0, 0}, bench::RunSpatialCases(spatial_stops, route_queries), {});
+        return 0;
+    }
+    if (all_pairs_vertices > 0) {
+        bench::PrintResults({"all_pairs", all_pairs_vertices / 2, 0, 0}, bench::RunAllPairsCases(all_pairs_vertices), {});
+        return 0;
+    }
+    if (representations) {
+        for (const auto& size : sizes) {
+            bench::PrintResults(size, bench::RunRepresentationCases(size, routing_settings, route_queries), {});
+        }
+        return 0;
+    }
+    if (wire_protocol) {
+        for (const auto& size : sizes) {
+            bench::PrintResults(size, bench::RunWireCases(size, routing_settings, route_queries), {});
+        }
+        return 0;
+    }
+    for (const auto& size : sizes) {
+        bench::GeoErrors geo_errors;
+        const auto results = bench::RunCases(size, routing_settings, route_queries, geo_errors);
+        bench::PrintResults(size, results, geo_errors);
+    }
+}
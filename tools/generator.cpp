@@ -0,0 +1,310 @@
+#include "geo.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace generator {
+
+struct Options {
+    size_t stops = 1000;
+    size_t buses = 100;
+    size_t min_route_length = 5;
+    size_t max_route_length = 30;
+    double roundtrip_ratio = 0.5;
+    double distance_density = 0.5;
+    size_t clusters = 8;
+    size_t requests = 1000;
+    std::vector<double> mix = {40, 40, 19, 1};
+    uint32_t seed = 1;
+};
+
+struct GeneratedStop {
+    geo::Coordinates coordinates;
+    std::vector<std::pair<size_t, int>> road_distances;
+};
+
+struct GeneratedBus {
+    std::vector<size_t> stops;
+    bool is_roundtrip = false;
+};
+
+// Сетка для выбора соседних остановок за O(1)
+class StopGrid {
+public:
+    StopGrid(const std::vector<GeneratedStop>& stops, double min_lat, double min_lng, double cell_size)
+        : min_lat_(min_lat)
+        , min_lng_(min_lng)
+        , cell_size_(cell_size) {
+        for (size_t i = 0; i < stops.size(); ++i) {
+            cells_[GetCell(stops[i].coordinates)].push_back(i);
+        }
+    }
+
+    std::pair<int64_t, int64_t> GetCell(geo::Coordinates coordinates) const {
+        return {static_cast<int64_t>((coordinates.lat - min_lat_) / cell_size_),
+                static_cast<int64_t>((coordinates.lng - min_lng_) / cell_size_)};
+    }
+
+    const std::vector<size_t>* GetStops(std::pair<int64_t, int64_t> cell) const {
+        const auto it = cells_.find(cell);
+        return it == cells_.end() ? nullptr : &it->second;
+    }
+
+private:
+    double min_lat_;
+    double min_lng_;
+    double cell_size_;
+    std::map<std::pair<int64_t, int64_t>, std::vector<size_t>> cells_;
+};
+
+std::string StopName(size_t index) {
+    return "Stop " + std::to_string(index);
+}
+
+std::string BusName(size_t index) {
+    return "Bus " + std::to_string(index);
+}
+
+std::vector<GeneratedStop> GenerateStops(const Options& options, std::mt19937_64& random) {
+    std::uniform_real_distribution<double> center_lat(55.55, 55.90);
+    std::uniform_real_distribution<double> center_lng(37.35, 37.85);
+    std::uniform_real_distribution<double> spread(0.01, 0.05);
+    std::vector<std::pair<geo::Coordinates, double>> centers;
+    for (size_t i = 0; i < std::max<size_t>(1, options.clusters); ++i) {
+        centers.push_back({{center_lat(random), center_lng(random)}, spread(random)});
+    }
+    std::uniform_int_distribution<size_t> pick_center(0, centers.size() - 1);
+    std::normal_distribution<double> offset(0.0, 1.0);
+    std::vector<GeneratedStop> stops(options.stops);
+    for (auto& stop : stops) {
+        const auto& [center, sigma] = centers[pick_center(random)];
+        stop.coordinates = {center.lat + offset(random) * sigma, center.lng + offset(random) * sigma * 1.7};
+    }
+    return stops;
+}
+
+int RoadDistance(const GeneratedStop& from, const GeneratedStop& to, std::mt19937_64& random) {
+    std::uniform_real_distribution<double> detour(1.1, 1.6);
+    return std::max(1, static_cast<int>(std::lround(geo::ComputeDistance(from.coordinates, to.coordinates) * detour(random))));
+}
+
+std::vector<GeneratedBus> GenerateBuses(const Options& options, std::vector<GeneratedStop>& stops, std::mt19937_64& random) {
+    auto [min_lat_it, max_lat_it] = std::minmax_element(stops.begin(), stops.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.coordinates.lat < rhs.coordinates.lat; });
+    auto [min_lng_it, max_lng_it] = std::minmax_element(stops.begin(), stops.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.coordinates.lng < rhs.coordinates.lng; });
+    // Примерно по 4 остановки на ячейку при равномерном распределении
+    const double area = (max_lat_it->coordinates.lat - min_lat_it->coordinates.lat)
+                        * (max_lng_it->coordinates.lng - min_lng_it->coordinates.lng);
+    const double cell_size = std::max(1e-5, std::sqrt(area * 4.0 / static_cast<double>(stops.size())));
+    const StopGrid grid(stops, min_lat_it->coordinates.lat, min_lng_it->coordinates.lng, cell_size);
+
+    std::uniform_int_distribution<size_t> pick_stop(0, stops.size() - 1);
+    std::uniform_int_distribution<size_t> pick_length(options.min_route_length, std::max(options.min_route_length, options.max_route_length));
+    std::uniform_int_distribution<int> step(-1, 1);
+    std::bernoulli_distribution is_roundtrip(options.roundtrip_ratio);
+    std::bernoulli_distribution has_reverse_distance(options.distance_density);
+
+    std::vector<std::unordered_map<size_t, int>> known_distances(stops.size());
+    auto add_distance = [&](size_t from, size_t to) {
+        if (!known_distances[from].count(to)) {
+            known_distances[from][to] = RoadDistance(stops[from], stops[to], random);
+        }
+    };
+
+    std::vector<GeneratedBus> buses(options.buses);
+    for (auto& bus : buses) {
+        bus.is_roundtrip = is_roundtrip(random);
+        const size_t length = std::max<size_t>(2, pick_length(random));
+        size_t current = pick_stop(random);
+        auto cell = grid.GetCell(stops[current].coordinates);
+        bus.stops.push_back(current);
+        // Случайное блуждание по соседним ячейкам сетки
+        for (size_t attempts = 0; bus.stops.size() < length && attempts < length * 20; ++attempts) {
+            const std::pair<int64_t, int64_t> next_cell{cell.first + step(random), cell.second + step(random)};
+            const auto* candidates = grid.GetStops(next_cell);
+            if (!candidates) {
+                continue;
+            }
+            const size_t next = (*candidates)[std::uniform_int_distribution<size_t>(0, candidates->size() - 1)(random)];
+            if (next == current) {
+                continue;
+            }
+            bus.stops.push_back(next);
+            current = next;
+            cell = next_cell;
+        }
+        if (bus.stops.size() < 2) {
+            size_t next = pick_stop(random);
+            if (next == current) {
+                next = (next + 1) % stops.size();
+            }
+            bus.stops.push_back(next);
+        }
+        if (bus.is_roundtrip) {
+            bus.stops.push_back(bus.stops.front());
+        }
+        for (size_t i = 1; i < bus.stops.size(); ++i) {
+            const size_t from = bus.stops[i - 1];
+            const size_t to = bus.stops[i];
+            add_distance(from, to);
+            if (!bus.is_roundtrip && has_reverse_distance(random)) {
+                add_distance(to, from);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < stops.size(); ++i) {
+        stops[i].road_distances.assign(known_distances[i].begin(), known_distances[i].end());
+        std::sort(stops[i].road_distances.begin(), stops[i].road_distances.end());
+    }
+    return buses;
+}
+
+void PrintBaseRequests(std::ostream& out, const std::vector<GeneratedStop>& stops, const std::vector<GeneratedBus>& buses) {
+    out << "\"base_requests\": [\n";
+    bool first = true;
+    for (size_t i = 0; i < stops.size(); ++i) {
+        out << (first ? "" : ",\n") << "{\"type\": \"Stop\", \"name\": \"" << StopName(i)
+            << "\", \"latitude\": " << stops[i].coordinates.lat
+            << ", \"longitude\": " << stops[i].coordinates.lng << ", \"road_distances\": {";
+        bool first_distance = true;
+        for (const auto& [to, distance] : stops[i].road_distances) {
+            out << (first_distance ? "" : ", ") << '"' << StopName(to) << "\": " << distance;
+            first_distance = false;
+        }
+        out << "}}";
+        first = false;
+    }
+    for (size_t i = 0; i < buses.size(); ++i) {
+        out << (first ? "" : ",\n") << "{\"type\": \"Bus\", \"name\": \"" << BusName(i)
+            << "\", \"is_roundtrip\": " << (buses[i].is_roundtrip ? "true" : "false") << ", \"stops\": [";
+        for (size_t j = 0; j < buses[i].stops.size(); ++j) {
+            out << (j == 0 ? "" : ", ") << '"' << StopName(buses[i].stops[j]) << '"';
+        }
+        out << "]}";
+        first = false;
+    }
+    out << "\n]";
+}
+
+void PrintSettings(std::ostream& out) {
+    out << "\"render_settings\": {\"width\": 1200, \"height\": 1200, \"padding\": 50, \"stop_radius\": 5,"
+           " \"line_width\": 14, \"bus_label_font_size\": 20, \"bus_label_offset\": [7, 15],"
+           " \"stop_label_font_size\": 20, \"stop_label_offset\": [7, -3],"
+           " \"underlayer_color\": [255, 255, 255, 0.85], \"underlayer_width\": 3,"
+           " \"color_palette\": [\"green\", [255, 160, 0], \"red\"]},\n"
+           "\"routing_settings\": {\"bus_wait_time\": 6, \"bus_velocity\": 40}";
+}
+
+void PrintStatRequests(std::ostream& out, const Options& options, size_t stops_count, size_t buses_count, std::mt19937_64& random) {
+    std::discrete_distribution<int> pick_type(options.mix.begin(), options.mix.end());
+    std::uniform_int_distribution<size_t> pick_stop(0, stops_count - 1);
+    std::uniform_int_distribution<size_t> pick_bus(0, std::max<size_t>(1, buses_count) - 1);
+    out << "\"stat_requests\": [\n";
+    for (size_t id = 1; id <= options.requests; ++id) {
+        out << (id == 1 ? "" : ",\n") << "{\"id\": " << id << ", ";
+        switch (pick_type(random)) {
+            case 0:
+                out << "\"type\": \"Bus\", \"name\": \"" << BusName(pick_bus(random)) << "\"}";
+                break;
+            case 1:
+                out << "\"type\": \"Stop\", \"name\": \"" << StopName(pick_stop(random)) << "\"}";
+                break;
+            case 2:
+                out << "\"type\": \"Route\", \"from\": \"" << StopName(pick_stop(random))
+                    << "\", \"to\": \"" << StopName(pick_stop(random)) << "\"}";
+                break;
+            default:
+                out << "\"type\": \"Map\"}";
+                break;
+        }
+    }
+    out << "\n]";
+}
+
+std::vector<double> ParseMix(const std::string& value) {
+    std::vector<double> result;
+    std::istringstream in(value);
+    for (std::string part; std::getline(in, part, ':');) {
+        result.push_back(std::stod(part));
+    }
+    if (result.size() != 4) {
+        throw std::invalid_argument("--mix expects bus:stop:route:map weights");
+    }
+    return result;
+}
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const std::string value = argv[i + 1];
+        if (name == "--stops") {
+            options.stops = std::stoul(value);
+        } else if (name == "--buses") {
+            options.buses = std::stoul(value);
+        } else if (name == "--min-route-length") {
+            options.min_route_length = std::stoul(value);
+        } else if (name == "--max-route-length") {
+            options.max_route_length = std::stoul(value);
+        } else if (name == "--roundtrip-ratio") {
+            options.roundtrip_ratio = std::stod(value);
+        } else if (name == "--distance-density") {
+            options.distance_density = std::stod(value);
+        } else if (name == "--clusters") {
+            options.clusters = std::stoul(value);
+        } else if (name == "--requests") {
+            options.requests = std::stoul(value);
+        } else if (name == "--mix") {
+            options.mix = ParseMix(value);
+        } else if (name == "--seed") {
+            options.seed = static_cast<uint32_t>(std::stoul(value));
+        } else {
+            throw std::invalid_argument("Unknown option " + name);
+        }
+    }
+    if (argc % 2 == 0) {
+        throw std::invalid_argument("Option without a value");
+    }
+    if (options.stops < 2) {
+        throw std::invalid_argument("At least two stops are required");
+    }
+    return options;
+}
+
+} // namespace generator
+
+int main(int argc, char* argv[]) {
+    using namespace generator;
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\nUsage: generator [--stops N] [--buses N] [--min-route-length N] [--max-route-length N]"
+                     " [--roundtrip-ratio X] [--distance-density X] [--clusters N] [--requests N]"
+                     " [--mix bus:stop:route:map] [--seed N]" << std::endl;
+        return 1;
+    }
+    std::ios::sync_with_stdio(false);
+    std::mt19937_64 random(options.seed);
+    auto stops = GenerateStops(options, random);
+    const auto buses = GenerateBuses(options, stops, random);
+    std::cout << std::setprecision(8) << "{\n";
+    PrintBaseRequests(std::cout, stops, buses);
+    std::cout << ",\n";
+    PrintSettings(std::cout);
+    std::cout << ",\n";
+    PrintStatRequests(std::cout, options, stops.size(), buses.size(), random);
+    std::cout << "\n}\n";
+}
@@ -0,0 +1,165 @@
+#include "histogram.h"
+#include "json_builder.h"
+#include "json_reader.h"
+#include "request_handler.h"
+#include "transport_snapshot.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace replay {
+
+struct Options {
+    std::string base_path;
+    std::string requests_path;
+    double rate = 0.0;
+    size_t repeat = 1;
+};
+
+struct TypeStats {
+    metrics::Histogram latency_ns;
+    uint64_t response_bytes = 0;
+};
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const std::string value = argv[i + 1];
+        if (name == "--base") {
+            options.base_path = value;
+        } else if (name == "--requests") {
+            options.requests_path = value;
+        } else if (name == "--rate") {
+            options.rate = std::stod(value);
+        } else if (name == "--repeat") {
+            options.repeat = std::stoul(value);
+        } else {
+            throw std::invalid_argument("Unknown option " + name);
+        }
+    }
+    if (options.base_path.empty()) {
+        throw std::invalid_argument("--base is required");
+    }
+    return options;
+}
+
+// Журнал запросов — либо массив stat_requests, либо документ с ключом stat_requests
+json::Array LoadRequests(const Options& options, const JsonReader& base) {
+    if (options.requests_path.empty()) {
+        const auto& stat_requests = base.GetStatRequests();
+        return stat_requests.IsNull() ? json::Array{} : stat_requests.AsArray();
+    }
+    std::ifstream input(options.requests_path);
+    if (!input) {
+        throw std::runtime_error("Cannot open " + options.requests_path);
+    }
+    json::Document document = json::Load(input);
+    if (document.GetRoot().IsArray()) {
+        return document.GetRoot().AsArray();
+    }
+    return document.GetRoot().AsDict().at("stat_requests").AsArray();
+}
+
+json::Node MakeTypeReport(const TypeStats& stats) {
+    const auto& histogram = stats.latency_ns;
+    auto to_us = [](uint64_t ns) {
+        return static_cast<double>(ns) / 1000.0;
+    };
+    return json::Builder{}.StartDict()
+            .Key("count").Value(static_cast<int>(histogram.GetCount()))
+            .Key("mean_us").Value(histogram.GetMean() / 1000.0)
+            .Key("p50_us").Value(to_us(histogram.GetPercentile(50)))
+            .Key("p95_us").Value(to_us(histogram.GetPercentile(95)))
+            .Key("p99_us").Value(to_us(histogram.GetPercentile(99)))
+            .Key("p999_us").Value(to_us(histogram.GetPercentile(99.9)))
+            .Key("max_us").Value(to_us(histogram.GetMax()))
+            .Key("response_bytes").Value(static_cast<double>(stats.response_bytes)).EndDict().Build();
+}
+
+} // namespace replay
+
+// Использование: replay --base base.json [--requests log.json] [--rate RPS] [--repeat N]
+// Задержка включает обработку запроса и сериализацию ответа в JSON. При заданном --rate она
+// считается от запланированного момента отправки, чтобы очередь за медленными запросами
+// не пропадала из статистики
+int main(int argc, char* argv[]) {
+    using namespace replay;
+    using Clock = std::chrono::steady_clock;
+    Options options;
+    try {
+        options = ParseOptions(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << "\nUsage: replay --base base.json [--requests log.json] [--rate RPS] [--repeat N]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream base_input(options.base_path);
+    if (!base_input) {
+        std::cerr << "Cannot open " << options.base_path << std::endl;
+        return 1;
+    }
+    const auto load_start = Clock::now();
+    JsonReader json_doc(base_input);
+    auto catalogue = std::make_shared<transport::Catalogue>();
+    json_doc.FillCatalogue(*catalogue);
+    const auto renderer = json_doc.FillRenderSettings(json_doc.GetRenderSettings());
+    const auto& routing_settings = json_doc.GetRoutingSettings();
+    transport::SnapshotHolder snapshots;
+    snapshots.Publish(std::move(catalogue), json_doc.FillRoutingSettings(routing_settings));
+    const auto snapshot = snapshots.Acquire();
+    RequestHandler req_hand(*snapshot, renderer, json_doc.FillRouteCacheCapacity(routing_settings));
+    const auto load_finish = Clock::now();
+
+    const json::Array requests_json = LoadRequests(options, json_doc);
+    const std::vector<StatRequest> requests = json_doc.DecodeStatRequests(requests_json, req_hand);
+    std::map<std::string, TypeStats> stats;
+    const auto interval = options.rate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate))
+        : Clock::duration::zero();
+
+    const auto replay_start = Clock::now();
+    size_t sent = 0;
+    for (size_t round = 0; round < options.repeat; ++round) {
+        for (const auto& request : requests) {
+            auto started = Clock::now();
+            if (options.rate > 0.0) {
+                const auto scheduled = replay_start + interval * sent;
+                std::this_thread::sleep_until(scheduled);
+                started = scheduled;
+            }
+            std::ostringstream out;
+            json::Print(json::Document{json_doc.HandleStatRequest(request, req_hand)}, out);
+            const auto finished = Clock::now();
+            auto& type_stats = stats[GetStatRequestTypeName(request.kind)];
+            type_stats.latency_ns.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(finished - started).count());
+            type_stats.response_bytes += out.str().size();
+            ++sent;
+        }
+    }
+    const auto replay_finish = Clock::now();
+
+    const double replay_seconds = std::chrono::duration<double>(replay_finish - replay_start).count();
+    json::Dict types;
+    TypeStats total_stats;
+    for (const auto& [type, type_stats] : stats) {
+        types.emplace(type, MakeTypeReport(type_stats));
+        total_stats.latency_ns.Merge(type_stats.latency_ns);
+        total_stats.response_bytes += type_stats.response_bytes;
+    }
+    json::Print(json::Document{json::Builder{}.StartDict()
+            .Key("load_seconds").Value(std::chrono::duration<double>(load_finish - load_start).count())
+            .Key("requests").Value(static_cast<int>(sent))
+            .Key("replay_seconds").Value(replay_seconds)
+            .Key("throughput_rps").Value(replay_seconds > 0.0 ? sent / replay_seconds : 0.0)
+            .Key("target_rps").Value(options.rate)
+            .Key("all").Value(MakeTypeReport(total_stats).AsDict())
+            .Key("types").Value(std::move(types)).EndDict().Build()}, std::cout);
+    std::cout << std::endl;
+}
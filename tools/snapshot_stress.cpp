@@ -0,0 +1,181 @@
+#include "transport_catalogue.h"
+#include "transport_router.h"
+#include "transport_snapshot.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace stress {
+
+struct Options {
+    size_t readers = 8;
+    size_t writers = 2;
+    size_t publishes = 50;
+    size_t stops = 50;
+};
+
+Options ParseOptions(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string name = argv[i];
+        const size_t value = std::stoul(argv[i + 1]);
+        if (name == "--readers") {
+            options.readers = value;
+        } else if (name == "--writers") {
+            options.writers = value;
+        } else if (name == "--publishes") {
+            options.publishes = value;
+        } else if (name == "--stops") {
+            options.stops = value;
+        } else {
+            throw std::invalid_argument("Unknown option " + name);
+        }
+    }
+    if (options.stops < 2) {
+        throw std::invalid_argument("--stops must be at least 2");
+    }
+    return options;
+}
+
+// Кольцевой маршрут через все остановки: любая пара остановок связана
+std::shared_ptr<const transport::Catalogue> MakeCatalogue(size_t stop_count) {
+    auto catalogue = std::make_shared<transport::Catalogue>();
+    std::vector<const transport::Stop*> stops;
+    for (size_t i = 0; i < stop_count; ++i) {
+        catalogue->AddStop("Stop " + std::to_string(i), {55.6 + 0.001 * i, 37.5 + 0.001 * i});
+        stops.push_back(catalogue->FindStop("Stop " + std::to_string(i)));
+    }
+    for (size_t i = 0; i < stop_count; ++i) {
+        catalogue->SetStopDistance(stops[i], stops[(i + 1) % stop_count], 500);
+    }
+    stops.push_back(stops.front());
+    catalogue->AddBus("Ring", stops, true);
+    catalogue->BuildIndexes();
+    return catalogue;
+}
+
+struct ReaderStats {
+    uint64_t acquires = 0;
+    uint64_t routes = 0;
+    uint64_t max_version = 0;
+    std::string error;
+};
+
+// Читатель проверяет, что версии не убывают и что каждый снимок целиком пригоден для запросов
+void RunReader(const transport::SnapshotHolder& holder, const std::atomic<bool>& done, size_t stop_count, ReaderStats& stats) {
+    size_t target = 1;
+    while (!done.load(std::memory_order_acquire)) {
+        const auto snapshot = holder.Acquire();
+        ++stats.acquires;
+        if (snapshot->version < stats.max_version) {
+            stats.error = "version went back from " + std::to_string(stats.max_version) + " to " + std::to_string(snapshot->version);
+            return;
+        }
+        stats.max_version = snapshot->version;
+        if (snapshot->version == 0) {
+            continue;
+        }
+        const auto* from = snapshot->catalogue->FindStop("Stop 0");
+        const auto* to = snapshot->catalogue->FindStop("Stop " + std::to_string(target));
+        if (!from || !to || !snapshot->router->FindRoute(from, to)) {
+            stats.error = "no route in snapshot " + std::to_string(snapshot->version);
+            return;
+        }
+        ++stats.routes;
+        target = target + 1 < stop_count ? target + 1 : 1;
+    }
+}
+
+} // namespace stress
+
+// Использование: snapshot_stress [--readers N] [--writers N] [--publishes N] [--stops N]
+// Читатели непрерывно берут снимки и ищут в них маршруты, писатели публикуют новые версии.
+// После остановки все снимки, кроме текущего, должны быть освобождены
+int main(int argc, char* argv[]) {
+    const stress::Options options = [&] {
+        try {
+            return stress::ParseOptions(argc, argv);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\nUsage: snapshot_stress [--readers N] [--writers N] [--publishes N] [--stops N]" << std::endl;
+            std::exit(1);
+        }
+    }();
+    const transport::TransportRouter::Settings routing_settings{6, 40.0};
+
+    transport::SnapshotHolder holder;
+    std::atomic<bool> done = false;
+    std::vector<stress::ReaderStats> reader_stats(options.readers);
+    std::vector<std::thread> readers;
+    for (auto& stats : reader_stats) {
+        readers.emplace_back(stress::RunReader, std::cref(holder), std::cref(done), options.stops, std::ref(stats));
+    }
+
+    std::mutex published_mutex;
+    std::map<uint64_t, std::weak_ptr<const transport::Catalogue>> published;
+    std::vector<std::thread> writers;
+    for (size_t writer = 0; writer < options.writers; ++writer) {
+        writers.emplace_back([&] {
+            for (size_t i = 0; i < options.publishes; ++i) {
+                auto catalogue = stress::MakeCatalogue(options.stops);
+                std::weak_ptr<const transport::Catalogue> weak = catalogue;
+                const uint64_t version = holder.Publish(std::move(catalogue), routing_settings);
+                std::lock_guard guard(published_mutex);
+                published.emplace(version, std::move(weak));
+            }
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    bool failed = false;
+    uint64_t acquires = 0;
+    uint64_t routes = 0;
+    for (const auto& stats : reader_stats) {
+        acquires += stats.acquires;
+        routes += stats.routes;
+        if (!stats.error.empty()) {
+            std::cerr << "reader error: " << stats.error << '\n';
+            failed = true;
+        }
+    }
+    const uint64_t current_version = holder.GetVersion();
+    if (current_version != options.writers * options.publishes || published.size() != current_version) {
+        std::cerr << "expected " << options.writers * options.publishes << " versions, current is " << current_version << '\n';
+        failed = true;
+    }
+    if (const size_t pending = holder.Reclaim(); pending != 0) {
+        std::cerr << pending << " retired snapshots are still pending after readers stopped\n";
+        failed = true;
+    }
+    size_t alive = 0;
+    for (const auto& [version, catalogue] : published) {
+        if (version != current_version && !catalogue.expired()) {
+            ++alive;
+        }
+    }
+    if (alive != 0) {
+        std::cerr << alive << " replaced snapshots are still alive\n";
+        failed = true;
+    }
+    if (published[current_version].expired()) {
+        std::cerr << "current snapshot has been freed\n";
+        failed = true;
+    }
+
+    std::cout << "readers=" << options.readers << " writers=" << options.writers << " versions=" << current_version
+              << " acquires=" << acquires << " routes=" << routes << (failed ? " FAILED" : " OK") << std::endl;
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+#include "graph.h"
+#include "stage_profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRAPH_ALL_PAIRS_X86
+#include <immintrin.h>
+#endif
+
+namespace graph {
+
+// Блочный Флойд–Уоршелл. Веса и последние рёбра маршрутов лежат в двух плоских матрицах
+// V×V по строкам; матрица режется на квадратные блоки, и на каждом шаге k сначала
+// пересчитывается диагональный блок, затем параллельно блоки его строки и столбца,
+// затем параллельно все остальные. Внутренний цикл — min-plus по строке блока (SIMD)
+namespace all_pairs {
+
+inline constexpr size_t BLOCK_SIZE = 64;
+template <typename Id>
+inline constexpr Id NO_EDGE = std::numeric_limits<Id>::max();
+
+// Для целых весов берётся половина максимума, чтобы сумма двух «бесконечностей» не переполнялась
+template <typename Weight>
+constexpr Weight GetUnreachableWeight() {
+    if constexpr (std::numeric_limits<Weight>::has_infinity) {
+        return std::numeric_limits<Weight>::infinity();
+    } else {
+        return std::numeric_limits<Weight>::max() / 2;
+    }
+}
+
+template <typename Weight, typename Id = size_t>
+struct Matrix {
+    size_t vertex_count = 0;
+    std::vector<Weight> weights;
+    std::vector<Id> last_edges;
+};
+
+namespace detail {
+
+// Релаксация строки row_to[begin, end) через вершину k: row_to[j] = min(row_to[j], via + row_k[j]).
+// При улучшении последним ребром маршрута становится последнее ребро маршрута k -> j
+template <typename Weight, typename Id>
+void RelaxRowScalar(Weight via, const Weight* row_k, const Id* edges_k,
+                    Weight* row_to, Id* edges_to, size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+        const Weight candidate = via + row_k[j];
+        if (candidate < row_to[j]) {
+            row_to[j] = candidate;
+            edges_to[j] = edges_k[j];
+        }
+    }
+}
+
+#ifdef GRAPH_ALL_PAIRS_X86
+
+// Веса и номера рёбер одного размера (double и 8 байт, float и 4 байта) занимают одинаковые
+// дорожки, поэтому одна маска сравнения подходит для смешивания обеих матриц
+template <typename Id>
+void RelaxRowSse2(double via, const double* row_k, const Id* edges_k,
+                  double* row_to, Id* edges_to, size_t begin, size_t end) {
+    static_assert(sizeof(Id) == sizeof(double));
+    const __m128d via_vector = _mm_set1_pd(via);
+    size_t j = begin;
+    for (; j + 2 <= end; j += 2) {
+        const __m128d candidate = _mm_add_pd(via_vector, _mm_loadu_pd(row_k + j));
+        const __m128d current = _mm_loadu_pd(row_to + j);
+        const __m128d mask = _mm_cmplt_pd(candidate, current);
+        _mm_storeu_pd(row_to + j, _mm_or_pd(_mm_and_pd(mask, candidate), _mm_andnot_pd(mask, current)));
+        const __m128d edge_k = _mm_castsi128_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(edges_k + j)));
+        const __m128d edge_to = _mm_castsi128_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(edges_to + j)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(edges_to + j),
+                         _mm_castpd_si128(_mm_or_pd(_mm_and_pd(mask, edge_k), _mm_andnot_pd(mask, edge_to))));
+    }
+    RelaxRowScalar(via, row_k, edges_k, row_to, edges_to, j, end);
+}
+
+template <typename Id>
+__attribute__((target("avx2")))
+void RelaxRowAvx2(double via, const double* row_k, const Id* edges_k,
+                  double* row_to, Id* edges_to, size_t begin, size_t end) {
+    static_assert(sizeof(Id) == sizeof(double));
+    const __m256d via_vector = _mm256_set1_pd(via);
+    size_t j = begin;
+    for (; j + 4 <= end; j += 4) {
+        const __m256d candidate = _mm256_add_pd(via_vector, _mm256_loadu_pd(row_k + j));
+        const __m256d current = _mm256_loadu_pd(row_to + j);
+        const __m256d mask = _mm256_cmp_pd(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_pd(row_to + j, _mm256_blendv_pd(current, candidate, mask));
+        const __m256d edge_k = _mm256_castsi256_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges_k + j)));
+        const __m256d edge_to = _mm256_castsi256_pd(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges_to + j)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(edges_to + j),
+                            _mm256_castpd_si256(_mm256_blendv_pd(edge_to, edge_k, mask)));
+    }
+    _mm256_zeroupper();
+    RelaxRowScalar(via, row_k, edges_k, row_to, edges_to, j, end);
+}
+
+template <typename Id>
+void RelaxRowSse2(float via, const float* row_k, const Id* edges_k,
+                  float* row_to, Id* edges_to, size_t begin, size_t end) {
+    static_assert(sizeof(Id) == sizeof(float));
+    const __m128 via_vector = _mm_set1_ps(via);
+    size_t j = begin;
+    for (; j + 4 <= end; j += 4) {
+        const __m128 candidate = _mm_add_ps(via_vector, _mm_loadu_ps(row_k + j));
+        const __m128 current = _mm_loadu_ps(row_to + j);
+        const __m128 mask = _mm_cmplt_ps(candidate, current);
+        _mm_storeu_ps(row_to + j, _mm_or_ps(_mm_and_ps(mask, candidate), _mm_andnot_ps(mask, current)));
+        const __m128 edge_k = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(edges_k + j)));
+        const __m128 edge_to = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(edges_to + j)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(edges_to + j),
+                         _mm_castps_si128(_mm_or_ps(_mm_and_ps(mask, edge_k), _mm_andnot_ps(mask, edge_to))));
+    }
+    RelaxRowScalar(via, row_k, edges_k, row_to, edges_to, j, end);
+}
+
+template <typename Id>
+__attribute__((target("avx2")))
+void RelaxRowAvx2(float via, const float* row_k, const Id* edges_k,
+                  float* row_to, Id* edges_to, size_t begin, size_t end) {
+    static_assert(sizeof(Id) == sizeof(float));
+    const __m256 via_vector = _mm256_set1_ps(via);
+    size_t j = begin;
+    for (; j + 8 <= end; j += 8) {
+        const __m256 candidate = _mm256_add_ps(via_vector, _mm256_loadu_ps(row_k + j));
+        const __m256 current = _mm256_loadu_ps(row_to + j);
+        const __m256 mask = _mm256_cmp_ps(candidate, current, _CMP_LT_OQ);
+        _mm256_storeu_ps(row_to + j, _mm256_blendv_ps(current, candidate, mask));
+        const __m256 edge_k = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges_k + j)));
+        const __m256 edge_to = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(edges_to + j)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(edges_to + j),
+                            _mm256_castps_si256(_mm256_blendv_ps(edge_to, edge_k, mask)));
+    }
+    _mm256_zeroupper();
+    RelaxRowScalar(via, row_k, edges_k, row_to, edges_to, j, end);
+}
+
+#endif
+
+// Многоразовый барьер на заданное число потоков (std::barrier появился только в C++20)
+class Barrier {
+public:
+    explicit Barrier(size_t thread_count)
+        : thread_count_(thread_count) {
+    }
+
+    void ArriveAndWait() {
+        std::unique_lock lock(mutex_);
+        const size_t generation = generation_;
+        if (++arrived_ == thread_count_) {
+            arrived_ = 0;
+            ++generation_;
+            condition_.notify_all();
+            return;
+        }
+        condition_.wait(lock, [this, generation] {
+            return generation_ != generation;
+        });
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable condition_;
+    size_t thread_count_;
+    size_t arrived_ = 0;
+    size_t generation_ = 0;
+};
+
+template <typename Weight, typename Id>
+class BlockedFloydWarshall {
+public:
+    // thread_count == 0 — по числу аппаратных потоков
+    explicit BlockedFloydWarshall(Matrix<Weight, Id>& matrix, size_t thread_count = 0)
+        : matrix_(matrix)
+        , vertex_count_(matrix.vertex_count)
+        , block_count_((matrix.vertex_count + BLOCK_SIZE - 1) / BLOCK_SIZE)
+        , thread_count_(thread_count > 0 ? thread_count : std::max<size_t>(std::thread::hardware_concurrency(), 1)) {
+#ifdef GRAPH_ALL_PAIRS_X86
+        use_avx2_ = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    // Потоки создаются один раз на весь расчёт и проходят шаги k вместе, разделяя фазы барьером
+    void Run() {
+        const size_t rest = block_count_ > 0 ? block_count_ - 1 : 0;
+        const size_t thread_count = std::min(thread_count_, rest * rest);
+        if (thread_count <= 1) {
+            for (size_t block_k = 0; block_k < block_count_; ++block_k) {
+                RelaxBlock(block_k, block_k, block_k);
+                for (size_t index = 0; index < 2 * rest; ++index) {
+                    RelaxCrossBlock(block_k, index);
+                }
+                for (size_t index = 0; index < rest * rest; ++index) {
+                    RelaxRestBlock(block_k, index);
+                }
+            }
+            return;
+        }
+        Barrier barrier(thread_count);
+        std::atomic<size_t> cross_next = 0;
+        std::atomic<size_t> rest_next = 0;
+        auto worker = [&](size_t thread_index) {
+            for (size_t block_k = 0; block_k < block_count_; ++block_k) {
+                if (thread_index == 0) {
+                    RelaxBlock(block_k, block_k, block_k);
+                    // Прошлый шаг закончился барьером, счётчиками уже никто не пользуется
+                    cross_next = 0;
+                    rest_next = 0;
+                }
+                barrier.ArriveAndWait();
+                RunShared(2 * rest, cross_next, [&](size_t index) {
+                    RelaxCrossBlock(block_k, index);
+                });
+                barrier.ArriveAndWait();
+                RunShared(rest * rest, rest_next, [&](size_t index) {
+                    RelaxRestBlock(block_k, index);
+                });
+                barrier.ArriveAndWait();
+            }
+        };
+        std::vector<std::thread> threads;
+        threads.reserve(thread_count - 1);
+        for (size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back([&worker, i] {
+                // Без этого этап предрасчёта с --perf-stages видел бы только ожидающий на барьере поток
+                profiling::ScopedWorker counters;
+                worker(i);
+            });
+        }
+        worker(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+private:
+    std::pair<size_t, size_t> GetBlockRange(size_t block) const {
+        return {block * BLOCK_SIZE, std::min(vertex_count_, (block + 1) * BLOCK_SIZE)};
+    }
+
+    void RelaxBlock(size_t block_i, size_t block_j, size_t block_k) {
+        const auto [i_begin, i_end] = GetBlockRange(block_i);
+        const auto [j_begin, j_end] = GetBlockRange(block_j);
+        const auto [k_begin, k_end] = GetBlockRange(block_k);
+        Weight* weights = matrix_.weights.data();
+        Id* last_edges = matrix_.last_edges.data();
+        for (size_t k = k_begin; k < k_end; ++k) {
+            const Weight* row_k = weights + k * vertex_count_;
+            const Id* edges_k = last_edges + k * vertex_count_;
+            for (size_t i = i_begin; i < i_end; ++i) {
+                Weight* row_i = weights + i * vertex_count_;
+                const Weight via = row_i[k];
+                if (!(via < UNREACHABLE)) {
+                    continue;
+                }
+                RelaxRow(via, row_k, edges_k, row_i, last_edges + i * vertex_count_, j_begin, j_end);
+            }
+        }
+    }
+
+    void RelaxRow(Weight via, const Weight* row_k, const Id* edges_k,
+                  Weight* row_to, Id* edges_to, size_t begin, size_t end) const {
+#ifdef GRAPH_ALL_PAIRS_X86
+        if constexpr ((std::is_same_v<Weight, double> || std::is_same_v<Weight, float>) && sizeof(Id) == sizeof(Weight)) {
+            if (use_avx2_) {
+                RelaxRowAvx2(via, row_k, edges_k, row_to, edges_to, begin, end);
+            } else {
+                RelaxRowSse2(via, row_k, edges_k, row_to, edges_to, begin, end);
+            }
+            return;
+        }
+#endif
+        RelaxRowScalar(via, row_k, edges_k, row_to, edges_to, begin, end);
+    }
+
+    // Индексы [0, count) разбираются потоками фазы через общий счётчик
+    template <typename Func>
+    static void RunShared(size_t count, std::atomic<size_t>& next, Func func) {
+        for (size_t index = next++; index < count; index = next++) {
+            func(index);
+        }
+    }
+
+    // Блоки строки и столбца block_k зависят только от диагонального блока
+    void RelaxCrossBlock(size_t block_k, size_t index) {
+        size_t other = index / 2;
+        other += other >= block_k ? 1 : 0;
+        if (index % 2 == 0) {
+            RelaxBlock(block_k, other, block_k);
+        } else {
+            RelaxBlock(other, block_k, block_k);
+        }
+    }
+
+    // Остальные блоки читают только строку и столбец block_k, уже посчитанные на этом шаге
+    void RelaxRestBlock(size_t block_k, size_t index) {
+        const size_t rest = block_count_ - 1;
+        size_t block_i = index / rest;
+        size_t block_j = index % rest;
+        block_i += block_i >= block_k ? 1 : 0;
+        block_j += block_j >= block_k ? 1 : 0;
+        RelaxBlock(block_i, block_j, block_k);
+    }
+
+    static constexpr Weight UNREACHABLE = GetUnreachableWeight<Weight>();
+    Matrix<Weight, Id>& matrix_;
+    size_t vertex_count_;
+    size_t block_count_;
+    size_t thread_count_;
+    bool use_avx2_ = false;
+};
+
+} // namespace detail
+
+template <typename Weight, typename Id>
+Matrix<Weight, Id> ComputeBlocked(const DirectedWeightedGraph<Weight, Id>& graph, size_t thread_count = 0) {
+    constexpr Weight zero_weight{};
+    Matrix<Weight, Id> matrix;
+    const size_t vertex_count = graph.GetVertexCount();
+    matrix.vertex_count = vertex_count;
+    matrix.weights.assign(vertex_count * vertex_count, GetUnreachableWeight<Weight>());
+    matrix.last_edges.assign(vertex_count * vertex_count, NO_EDGE<Id>);
+    for (Id vertex = 0; vertex < vertex_count; ++vertex) {
+        Weight* row = matrix.weights.data() + vertex * vertex_count;
+        row[vertex] = zero_weight;
+        for (const Id edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < zero_weight) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            if (edge.weight < row[edge.to]) {
+                row[edge.to] = edge.weight;
+                matrix.last_edges[vertex * vertex_count + edge.to] = edge_id;
+            }
+        }
+    }
+    detail::BlockedFloydWarshall<Weight, Id>(matrix, thread_count).Run();
+    return matrix;
+}
+
+} // namespace all_pairs
+
+}  // namespace graph
@@ -2,23 +2,38 @@
 
 #include "geo.h"
 
-#include <set>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
 
 namespace transport {
 
+constexpr static double K_MH_TO_M_MIN = 1000.0 / 60.0;
+
 struct Stop {
     std::string name;
     geo::Coordinates coordinates;
-    std::set<std::string> buses;
+    // Порядковый номер остановки в каталоге
+    uint32_t id = 0;
+};
+
+// Расписание отправлений с первой остановки, минуты от начала суток
+struct BusSchedule {
+    int first_departure = 0;
+    int last_departure = 1440;
+    int interval = 0;
 };
 
 struct Bus {
     std::string number;
     std::vector<const Stop*> stops;
     bool is_roundtrip;
+    // Порядковый номер маршрута в каталоге
+    uint32_t id = 0;
+    // Без расписания рейсы идут весь день с интервалом 2 * bus_wait_time
+    std::optional<BusSchedule> schedule;
 };
 
 struct BusInfo {
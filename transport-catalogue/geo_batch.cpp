@@ -0,0 +1,188 @@
+#include "geo_batch.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GEO_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace geo {
+
+namespace {
+
+// Та же константа, что и в ComputeDistance, чтобы результаты совпадали
+constexpr double DEGREES_TO_RADIANS = 3.1415926535 / 180.;
+
+constexpr size_t BLOCK_SIZE = 256;
+
+// Для COSINES в values попадает скалярное произведение, для HAVERSINE — квадрат длины хорды
+double ToDistance(double value, DistanceFormula formula) {
+    if (formula == DistanceFormula::COSINES) {
+        return std::acos(std::clamp(value, -1.0, 1.0)) * EARTH_RADIUS;
+    }
+    return ChordToDistance(std::sqrt(value));
+}
+
+double ComputeSegmentValue(const UnitVectors& points, uint32_t from, uint32_t to, DistanceFormula formula) {
+    const double* x = points.GetX();
+    const double* y = points.GetY();
+    const double* z = points.GetZ();
+    if (formula == DistanceFormula::COSINES) {
+        return x[from] * x[to] + y[from] * y[to] + z[from] * z[to];
+    }
+    const double dx = x[from] - x[to];
+    const double dy = y[from] - y[to];
+    const double dz = z[from] - z[to];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Совпадающие точки дают нулевое расстояние, как и в ComputeDistance, без погрешности acos около единицы
+bool IsSamePoint(const UnitVectors& points, uint32_t from, uint32_t to) {
+    return from == to || (points.GetX()[from] == points.GetX()[to] && points.GetY()[from] == points.GetY()[to]
+                          && points.GetZ()[from] == points.GetZ()[to]);
+}
+
+void ComputeBlockScalar(const UnitVectors& points, const uint32_t* path, size_t count, DistanceFormula formula, double* values) {
+    for (size_t i = 0; i < count; ++i) {
+        values[i] = ComputeSegmentValue(points, path[i], path[i + 1], formula);
+    }
+}
+
+#ifdef GEO_BATCH_X86
+
+// SSE2 есть на любом x86-64: по два отрезка за итерацию, без gather
+void ComputeBlockSse2(const UnitVectors& points, const uint32_t* path, size_t count, DistanceFormula formula, double* values) {
+    const double* x = points.GetX();
+    const double* y = points.GetY();
+    const double* z = points.GetZ();
+    size_t i = 0;
+    for (; i + 2 <= count; i += 2) {
+        const uint32_t a0 = path[i], a1 = path[i + 1], b1 = path[i + 2];
+        const __m128d ax = _mm_set_pd(x[a1], x[a0]), bx = _mm_set_pd(x[b1], x[a1]);
+        const __m128d ay = _mm_set_pd(y[a1], y[a0]), by = _mm_set_pd(y[b1], y[a1]);
+        const __m128d az = _mm_set_pd(z[a1], z[a0]), bz = _mm_set_pd(z[b1], z[a1]);
+        __m128d result;
+        if (formula == DistanceFormula::COSINES) {
+            result = _mm_add_pd(_mm_add_pd(_mm_mul_pd(ax, bx), _mm_mul_pd(ay, by)), _mm_mul_pd(az, bz));
+        } else {
+            const __m128d dx = _mm_sub_pd(ax, bx), dy = _mm_sub_pd(ay, by), dz = _mm_sub_pd(az, bz);
+            result = _mm_add_pd(_mm_add_pd(_mm_mul_pd(dx, dx), _mm_mul_pd(dy, dy)), _mm_mul_pd(dz, dz));
+        }
+        _mm_storeu_pd(values + i, result);
+    }
+    ComputeBlockScalar(points, path + i, count - i, formula, values + i);
+}
+
+// _mm256_i32gather_pd в GCC 12 берёт неинициализированный исходный вектор и даёт -Wmaybe-uninitialized;
+// маскированная форма с нулевым источником и полной маской собирает те же значения
+__attribute__((target("avx2")))
+inline __m256d Gather(const double* base, __m128i indexes) {
+    const __m256d all_lanes = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+    return _mm256_mask_i32gather_pd(_mm256_setzero_pd(), base, indexes, all_lanes, 8);
+}
+
+// AVX2: по четыре отрезка, координаты концов собираются gather-инструкциями по индексам пути
+__attribute__((target("avx2,fma")))
+void ComputeBlockAvx2(const UnitVectors& points, const uint32_t* path, size_t count, DistanceFormula formula, double* values) {
+    const double* x = points.GetX();
+    const double* y = points.GetY();
+    const double* z = points.GetZ();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const __m128i from = _mm_loadu_si128(reinterpret_cast<const __m128i*>(path + i));
+        const __m128i to = _mm_loadu_si128(reinterpret_cast<const __m128i*>(path + i + 1));
+        const __m256d ax = Gather(x, from), bx = Gather(x, to);
+        const __m256d ay = Gather(y, from), by = Gather(y, to);
+        const __m256d az = Gather(z, from), bz = Gather(z, to);
+        __m256d result;
+        if (formula == DistanceFormula::COSINES) {
+            result = _mm256_fmadd_pd(az, bz, _mm256_fmadd_pd(ay, by, _mm256_mul_pd(ax, bx)));
+        } else {
+            const __m256d dx = _mm256_sub_pd(ax, bx), dy = _mm256_sub_pd(ay, by), dz = _mm256_sub_pd(az, bz);
+            result = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+        }
+        _mm256_storeu_pd(values + i, result);
+    }
+    // Иначе скалярный хвост и libm выполняются с грязной верхней половиной регистров и платят за переход SSE/AVX
+    _mm256_zeroupper();
+    ComputeBlockScalar(points, path + i, count - i, formula, values + i);
+}
+
+#endif
+
+using BlockKernel = void (*)(const UnitVectors&, const uint32_t*, size_t, DistanceFormula, double*);
+
+BlockKernel SelectBlockKernel() {
+#ifdef GEO_BATCH_X86
+    // gather индексирует знаковыми 32-битными смещениями; путь хранит uint32_t, поэтому
+    // AVX2 используется, только пока число точек помещается в int32_t (проверяется при вызове)
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+        return ComputeBlockAvx2;
+    }
+    return ComputeBlockSse2;
+#else
+    return ComputeBlockScalar;
+#endif
+}
+
+} // namespace
+
+UnitVector ToUnitVector(Coordinates coordinates) {
+    const double lat = coordinates.lat * DEGREES_TO_RADIANS;
+    const double lng = coordinates.lng * DEGREES_TO_RADIANS;
+    return {std::cos(lat) * std::cos(lng), std::cos(lat) * std::sin(lng), std::sin(lat)};
+}
+
+double ChordToDistance(double chord) {
+    return 2.0 * std::asin(std::min(1.0, chord / 2.0)) * EARTH_RADIUS;
+}
+
+double DistanceToChord(double distance) {
+    return 2.0 * std::sin(std::min(distance / (2.0 * EARTH_RADIUS), std::asin(1.0)));
+}
+
+size_t UnitVectors::Add(Coordinates coordinates) {
+    const UnitVector vector = ToUnitVector(coordinates);
+    x_.push_back(vector.x);
+    y_.push_back(vector.y);
+    z_.push_back(vector.z);
+    return x_.size() - 1;
+}
+
+void UnitVectors::Reserve(size_t count) {
+    x_.reserve(count);
+    y_.reserve(count);
+    z_.reserve(count);
+}
+
+double ComputeDistance(const UnitVectors& points, uint32_t from, uint32_t to, DistanceFormula formula) {
+    if (IsSamePoint(points, from, to)) {
+        return 0;
+    }
+    return ToDistance(ComputeSegmentValue(points, from, to, formula), formula);
+}
+
+double ComputePathLength(const UnitVectors& points, const std::vector<uint32_t>& path, DistanceFormula formula) {
+    static const BlockKernel fast_kernel = SelectBlockKernel();
+    if (path.size() < 2) {
+        return 0;
+    }
+    const BlockKernel kernel = points.GetSize() <= INT32_MAX ? fast_kernel : ComputeBlockScalar;
+    const size_t segment_count = path.size() - 1;
+    double values[BLOCK_SIZE];
+    double result = 0;
+    for (size_t start = 0; start < segment_count; start += BLOCK_SIZE) {
+        const size_t count = std::min(BLOCK_SIZE, segment_count - start);
+        kernel(points, path.data() + start, count, formula, values);
+        for (size_t i = 0; i < count; ++i) {
+            if (!IsSamePoint(points, path[start + i], path[start + i + 1])) {
+                result += ToDistance(values[i], formula);
+            }
+        }
+    }
+    return result;
+}
+
+} // namespace geo
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "geo.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace geo {
+
+// COSINES повторяет формулу ComputeDistance (сферическая теорема косинусов),
+// HAVERSINE считает угол через длину хорды и устойчив на коротких расстояниях
+enum class DistanceFormula {
+    COSINES,
+    HAVERSINE,
+};
+
+inline constexpr double EARTH_RADIUS = 6371000;
+
+struct UnitVector {
+    double x = 0;
+    double y = 0;
+    double z = 0;
+};
+
+UnitVector ToUnitVector(Coordinates coordinates);
+
+// Перевод между длиной хорды единичной сферы и расстоянием по поверхности Земли в метрах
+double ChordToDistance(double chord);
+double DistanceToChord(double distance);
+
+// Точки на сфере в виде единичных векторов. Синусы и косинусы считаются один раз при добавлении,
+// координаты векторов хранятся отдельными массивами (SoA), чтобы их можно было читать векторными инструкциями
+class UnitVectors {
+public:
+    size_t Add(Coordinates coordinates);
+    void Reserve(size_t count);
+
+    size_t GetSize() const {
+        return x_.size();
+    }
+    const double* GetX() const {
+        return x_.data();
+    }
+    const double* GetY() const {
+        return y_.data();
+    }
+    const double* GetZ() const {
+        return z_.data();
+    }
+
+private:
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+};
+
+double ComputeDistance(const UnitVectors& points, uint32_t from, uint32_t to, DistanceFormula formula = DistanceFormula::COSINES);
+
+// Сумма расстояний между соседними точками пути. Скалярные произведения и хорды считаются
+// блоками с AVX2 (если процессор его поддерживает) или SSE2, обратные тригонометрические функции — скалярно
+double ComputePathLength(const UnitVectors& points, const std::vector<uint32_t>& path, DistanceFormula formula = DistanceFormula::COSINES);
+
+} // namespace geo
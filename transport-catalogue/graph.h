@@ -1,8 +1,11 @@
 #pragma once
 
+#include "memory_usage.h"
 #include "ranges.h"
 
 #include <cstdlib>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 namespace graph {
@@ -10,16 +13,22 @@ namespace graph {
 using VertexId = size_t;
 using EdgeId = size_t;
 
-template <typename Weight>
+// Id — тип номеров вершин и рёбер. uint32_t вдвое сокращает списки смежности и таблицы
+// маршрутизатора, если в графе меньше 2^32 рёбер
+template <typename Weight, typename Id = size_t>
 struct Edge {
     std::string type;
-    VertexId from;
-    VertexId to;
+    Id from;
+    Id to;
     Weight weight;
 };
 
-template <typename Weight>
+template <typename Weight, typename Id = size_t>
 class DirectedWeightedGraph {
+public:
+    using VertexId = Id;
+    using EdgeId = Id;
+
 private:
     using IncidenceList = std::vector<EdgeId>;
     using IncidentEdgesRange = ranges::Range<typename IncidenceList::const_iterator>;
@@ -27,49 +36,75 @@ private:
 public:
     DirectedWeightedGraph() = default;
     explicit DirectedWeightedGraph(size_t vertex_count);
-    EdgeId AddEdge(const Edge<Weight>& edge);
+    EdgeId AddEdge(const Edge<Weight, Id>& edge);
 
     size_t GetVertexCount() const;
     size_t GetEdgeCount() const;
-    const Edge<Weight>& GetEdge(EdgeId edge_id) const;
+    const Edge<Weight, Id>& GetEdge(EdgeId edge_id) const;
     IncidentEdgesRange GetIncidentEdges(VertexId vertex) const;
 
+    memory::Usage GetEdgesMemoryUsage() const;
+    memory::Usage GetIncidenceMemoryUsage() const;
+
 private:
-    std::vector<Edge<Weight>> edges_;
+    std::vector<Edge<Weight, Id>> edges_;
     std::vector<IncidenceList> incidence_lists_;
 };
 
-template <typename Weight>
-DirectedWeightedGraph<Weight>::DirectedWeightedGraph(size_t vertex_count)
+template <typename Weight, typename Id>
+DirectedWeightedGraph<Weight, Id>::DirectedWeightedGraph(size_t vertex_count)
     : incidence_lists_(vertex_count) {
 }
 
-template <typename Weight>
-EdgeId DirectedWeightedGraph<Weight>::AddEdge(const Edge<Weight>& edge) {
+template <typename Weight, typename Id>
+Id DirectedWeightedGraph<Weight, Id>::AddEdge(const Edge<Weight, Id>& edge) {
+    // Максимальное значение Id занято под «нет ребра» в таблицах маршрутизатора
+    if (edges_.size() >= std::numeric_limits<EdgeId>::max()) {
+        throw std::length_error("Edge count exceeds the range of graph ids");
+    }
     edges_.push_back(edge);
-    const EdgeId id = edges_.size() - 1;
+    const EdgeId id = static_cast<EdgeId>(edges_.size() - 1);
     incidence_lists_.at(edge.from).push_back(id);
     return id;
 }
 
-template <typename Weight>
-size_t DirectedWeightedGraph<Weight>::GetVertexCount() const {
+template <typename Weight, typename Id>
+size_t DirectedWeightedGraph<Weight, Id>::GetVertexCount() const {
     return incidence_lists_.size();
 }
 
-template <typename Weight>
-size_t DirectedWeightedGraph<Weight>::GetEdgeCount() const {
+template <typename Weight, typename Id>
+size_t DirectedWeightedGraph<Weight, Id>::GetEdgeCount() const {
     return edges_.size();
 }
 
-template <typename Weight>
-const Edge<Weight>& DirectedWeightedGraph<Weight>::GetEdge(EdgeId edge_id) const {
+template <typename Weight, typename Id>
+const Edge<Weight, Id>& DirectedWeightedGraph<Weight, Id>::GetEdge(EdgeId edge_id) const {
     return edges_.at(edge_id);
 }
 
-template <typename Weight>
-typename DirectedWeightedGraph<Weight>::IncidentEdgesRange
-DirectedWeightedGraph<Weight>::GetIncidentEdges(VertexId vertex) const {
+template <typename Weight, typename Id>
+typename DirectedWeightedGraph<Weight, Id>::IncidentEdgesRange
+DirectedWeightedGraph<Weight, Id>::GetIncidentEdges(VertexId vertex) const {
     return ranges::AsRange(incidence_lists_.at(vertex));
 }
+
+template <typename Weight, typename Id>
+memory::Usage DirectedWeightedGraph<Weight, Id>::GetEdgesMemoryUsage() const {
+    memory::Usage result = memory::EstimateVectorBuffer(edges_);
+    for (const auto& edge : edges_) {
+        result += memory::EstimateString(edge.type);
+    }
+    return result;
+}
+
+template <typename Weight, typename Id>
+memory::Usage DirectedWeightedGraph<Weight, Id>::GetIncidenceMemoryUsage() const {
+    memory::Usage result = memory::EstimateVectorBuffer(incidence_lists_);
+    for (const auto& incidence_list : incidence_lists_) {
+        result += memory::EstimateVectorBuffer(incidence_list);
+    }
+    return result;
+}
+
 }  // namespace graph
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace metrics {
+
+// Гистограмма в духе HDR: значения меньше 32 хранятся точно, остальные попадают
+// в логарифмические корзины по 16 линейных подкорзин, относительная погрешность не больше 1/16
+class Histogram {
+public:
+    static constexpr size_t EXACT_BUCKETS = 32;
+    static constexpr size_t SUB_BUCKETS = 16;
+    static constexpr size_t BUCKET_COUNT = EXACT_BUCKETS + 59 * SUB_BUCKETS;
+
+    void Record(uint64_t value) {
+        ++counts_[GetBucketIndex(value)];
+        ++count_;
+        sum_ += value;
+        max_ = std::max(max_, value);
+    }
+
+    void Merge(const Histogram& other) {
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            counts_[i] += other.counts_[i];
+        }
+        count_ += other.count_;
+        sum_ += other.sum_;
+        max_ = std::max(max_, other.max_);
+    }
+
+    void MergeBucket(size_t index, uint64_t count) {
+        counts_[index] += count;
+        count_ += count;
+    }
+
+    void MergeTotals(uint64_t sum, uint64_t max) {
+        sum_ += sum;
+        max_ = std::max(max_, max);
+    }
+
+    uint64_t GetCount() const {
+        return count_;
+    }
+
+    uint64_t GetSum() const {
+        return sum_;
+    }
+
+    uint64_t GetMax() const {
+        return max_;
+    }
+
+    double GetMean() const {
+        return count_ == 0 ? 0.0 : static_cast<double>(sum_) / count_;
+    }
+
+    // percentile задаётся в диапазоне [0, 100]; возвращается верхняя граница корзины
+    uint64_t GetPercentile(double percentile) const {
+        if (count_ == 0) {
+            return 0;
+        }
+        const auto rank = static_cast<uint64_t>(percentile / 100.0 * static_cast<double>(count_) + 0.5);
+        const uint64_t target = std::clamp<uint64_t>(rank, 1, count_);
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += counts_[i];
+            if (seen >= target) {
+                return std::min(GetBucketUpperBound(i), max_);
+            }
+        }
+        return max_;
+    }
+
+    uint64_t GetBucketCount(size_t index) const {
+        return counts_[index];
+    }
+
+    static size_t GetBucketIndex(uint64_t value) {
+        if (value < EXACT_BUCKETS) {
+            return static_cast<size_t>(value);
+        }
+        const int shift = GetHighestBit(value) - 4;
+        const uint64_t top = value >> shift;
+        return EXACT_BUCKETS + static_cast<size_t>(shift - 1) * SUB_BUCKETS + static_cast<size_t>(top - SUB_BUCKETS);
+    }
+
+    static uint64_t GetBucketUpperBound(size_t index) {
+        if (index < EXACT_BUCKETS) {
+            return index;
+        }
+        const size_t shift = (index - EXACT_BUCKETS) / SUB_BUCKETS + 1;
+        const uint64_t top = (index - EXACT_BUCKETS) % SUB_BUCKETS + SUB_BUCKETS;
+        const uint64_t upper = (top + 1) << shift;
+        return upper == 0 ? UINT64_MAX : upper - 1;
+    }
+
+private:
+    static int GetHighestBit(uint64_t value) {
+#if defined(__GNUC__)
+        return 63 - __builtin_clzll(value);
+#else
+        int result = 0;
+        while (value >>= 1) {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    std::array<uint64_t, BUCKET_COUNT> counts_{};
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+};
+
+}  // namespace metrics
@@ -1,6 +1,13 @@
 #include "json.h"
 
+#include <charconv>
 #include <iterator>
+#include <locale>
+
+#if defined(__SSE2__)
+#define JSON_PRINT_SSE2
+#include <emmintrin.h>
+#endif
 
 namespace json {
 
@@ -8,7 +15,7 @@ namespace {
 using namespace std::literals;
 
 Node LoadNode(std::istream& input);
-Node LoadString(std::istream& input);
+std::string LoadString(std::istream& input);
 
 std::string LoadLiteral(std::istream& input) {
  std::string s;
@@ -34,16 +41,15 @@ Node LoadArray(std::istream& input) {
 }
 
 Node LoadDict(std::istream& input) {
-    Dict dict;
+    // Типичный объект запроса — три-четыре ключа, и массив пар выделяется один раз
+    std::vector<Dict::value_type> entries;
+    entries.reserve(4);
 
     for (char c; input >> c && c != '}';) {
         if (c == '"') {
-            std::string key = LoadString(input).AsString();
+            std::string key = LoadString(input);
             if (input >> c && c == ':') {
-                if (dict.find(key) != dict.end()) {
-                    throw ParsingError("Duplicate key '"s + key + "' have been found");
-                }
-                dict.emplace(std::move(key), LoadNode(input));
+                entries.emplace_back(std::move(key), LoadNode(input));
             } else {
                 throw ParsingError(": is expected but '"s + c + "' has been found"s);
             }
@@ -54,10 +60,14 @@ Node LoadDict(std::istream& input) {
     if (!input) {
         throw ParsingError("Dictionary parsing error"s);
     }
-    return Node(std::move(dict));
+    try {
+        return Node(Dict(std::move(entries)));
+    } catch (const std::invalid_argument& error) {
+        throw ParsingError(error.what());
+    }
 }
 
-Node LoadString(std::istream& input) {
+std::string LoadString(std::istream& input) {
     auto it = std::istreambuf_iterator<char>(input);
     auto end = std::istreambuf_iterator<char>();
     std::string s;
@@ -102,7 +112,7 @@ Node LoadString(std::istream& input) {
         ++it;
     }
 
-    return Node(std::move(s));
+    return s;
 }
 
 Node LoadBool(std::istream& input) {
@@ -201,7 +211,7 @@ Node LoadNode(std::istream& input) {
         case '{':
             return LoadDict(input);
         case '"':
-            return LoadString(input);
+            return Node(LoadString(input));
         case 't':
             // Атрибут [[fallthrough]] (провалиться) ничего не делает, и является
             // подсказкой компилятору и человеку, что здесь программист явно задумывал
@@ -222,54 +232,189 @@ Node LoadNode(std::istream& input) {
     }
 }
 
+// Вывод копится в буфере и уходит в поток блоками, а не посимвольно через std::ostream
+class Writer {
+public:
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+    explicit Writer(std::ostream& out)
+        : out_(out) {
+        buffer_.reserve(BUFFER_SIZE);
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    ~Writer() {
+        Flush();
+    }
+
+    void Put(char c) {
+        if (buffer_.size() == BUFFER_SIZE) {
+            Flush();
+        }
+        buffer_.push_back(c);
+    }
+
+    void Write(std::string_view text) {
+        if (buffer_.size() + text.size() > BUFFER_SIZE) {
+            Flush();
+            if (text.size() >= BUFFER_SIZE) {
+                out_.write(text.data(), static_cast<std::streamsize>(text.size()));
+                return;
+            }
+        }
+        buffer_.append(text);
+    }
+
+    void Fill(char c, size_t count) {
+        while (count > 0) {
+            if (buffer_.size() == BUFFER_SIZE) {
+                Flush();
+            }
+            const size_t chunk = std::min(count, BUFFER_SIZE - buffer_.size());
+            buffer_.append(chunk, c);
+            count -= chunk;
+        }
+    }
+
+    void Flush() {
+        out_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        buffer_.clear();
+    }
+
+    std::ostream& GetStream() {
+        return out_;
+    }
+
+private:
+    std::ostream& out_;
+    std::string buffer_;
+};
+
 struct PrintContext {
-    std::ostream& out;
+    Writer& out;
+    // Числа печатаются через std::to_chars, если поток настроен по умолчанию (кроме точности):
+    // результат тот же, что у operator<<, то есть %g с точностью потока
+    bool plain_numbers = true;
+    int precision = 6;
     int indent_step = 4;
     int indent = 0;
 
     void PrintIndent() const {
-        for (int i = 0; i < indent; ++i) {
-            out.put(' ');
-        }
+        out.Fill(' ', static_cast<size_t>(indent));
     }
 
     PrintContext Indented() const {
-        return {out, indent_step, indent_step + indent};
+        return {out, plain_numbers, precision, indent_step, indent_step + indent};
     }
 };
 
+bool HasPlainNumberFormat(const std::ostream& out) {
+    const auto flags = out.flags();
+    const auto base = flags & std::ios_base::basefield;
+    return (flags & (std::ios_base::floatfield | std::ios_base::showpoint | std::ios_base::showpos | std::ios_base::uppercase)) == 0
+        && (base == std::ios_base::dec || base == std::ios_base::fmtflags{})
+        && out.getloc() == std::locale::classic();
+}
+
 void PrintNode(const Node& value, const PrintContext& ctx);
 
 template <typename Value>
 void PrintValue(const Value& value, const PrintContext& ctx) {
-    ctx.out << value;
+    ctx.out.Flush();
+    ctx.out.GetStream() << value;
 }
 
-void PrintString(const std::string& value, std::ostream& out) {
-    out.put('"');
-    for (const char c : value) {
-        switch (c) {
+template <>
+void PrintValue<int>(const int& value, const PrintContext& ctx) {
+    if (!ctx.plain_numbers) {
+        ctx.out.Flush();
+        ctx.out.GetStream() << value;
+        return;
+    }
+    char buffer[16];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    ctx.out.Write({buffer, static_cast<size_t>(result.ptr - buffer)});
+}
+
+template <>
+void PrintValue<double>(const double& value, const PrintContext& ctx) {
+    if (!ctx.plain_numbers) {
+        ctx.out.Flush();
+        ctx.out.GetStream() << value;
+        return;
+    }
+    // Самое длинное представление %g — знак, 17 значащих цифр с точкой и экспонента — короче 32 символов,
+    // если точность не больше 17; для большей точности буфер больше
+    char buffer[32];
+    if (ctx.precision <= 17) {
+        const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::general, ctx.precision);
+        ctx.out.Write({buffer, static_cast<size_t>(result.ptr - buffer)});
+        return;
+    }
+    std::string wide(static_cast<size_t>(ctx.precision) + 32, '\0');
+    const auto result = std::to_chars(wide.data(), wide.data() + wide.size(), value, std::chars_format::general, ctx.precision);
+    ctx.out.Write({wide.data(), static_cast<size_t>(result.ptr - wide.data())});
+}
+
+bool NeedsEscape(char c) {
+    return c == '"' || c == '\\' || c == '\r' || c == '\n' || c == '\t';
+}
+
+// Позиция первого символа, который выводится с экранированием, начиная с pos; длинные строки
+// (SVG карты) проверяются по 16 байт за шаг, и участки без таких символов копируются целиком
+size_t FindEscape(std::string_view text, size_t pos) {
+#ifdef JSON_PRINT_SSE2
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i carriage_return = _mm_set1_epi8('\r');
+    const __m128i line_feed = _mm_set1_epi8('\n');
+    const __m128i tab = _mm_set1_epi8('\t');
+    for (; pos + 16 <= text.size(); pos += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+        const __m128i hits = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, carriage_return), _mm_cmpeq_epi8(chunk, line_feed)),
+                         _mm_cmpeq_epi8(chunk, tab)));
+        if (const int mask = _mm_movemask_epi8(hits); mask != 0) {
+            return pos + static_cast<size_t>(__builtin_ctz(static_cast<unsigned>(mask)));
+        }
+    }
+#endif
+    while (pos < text.size() && !NeedsEscape(text[pos])) {
+        ++pos;
+    }
+    return pos;
+}
+
+void PrintString(std::string_view value, Writer& out) {
+    out.Put('"');
+    for (size_t pos = 0; pos < value.size();) {
+        const size_t escape = FindEscape(value, pos);
+        out.Write(value.substr(pos, escape - pos));
+        if (escape == value.size()) {
+            break;
+        }
+        switch (value[escape]) {
             case '\r':
-                out << "\\r"sv;
+                out.Write("\\r"sv);
                 break;
             case '\n':
-                out << "\\n"sv;
+                out.Write("\\n"sv);
                 break;
             case '\t':
-                out << "\\t"sv;
+                out.Write("\\t"sv);
                 break;
-            case '"':
-                // Символы " и \ выводятся как \" или \\, соответственно
-                [[fallthrough]];
-            case '\\':
-                out.put('\\');
-                [[fallthrough]];
             default:
-                out.put(c);
+                // Символы " и \ выводятся как \" или \\, соответственно
+                out.Put('\\');
+                out.Put(value[escape]);
                 break;
         }
+        pos = escape + 1;
     }
-    out.put('"');
+    out.Put('"');
 }
 
 template <>
@@ -279,74 +424,112 @@ void PrintValue<std::string>(const std::string& value, const PrintContext& ctx)
 
 template <>
 void PrintValue<std::nullptr_t>(const std::nullptr_t&, const PrintContext& ctx) {
-    ctx.out << "null"sv;
+    ctx.out.Write("null"sv);
 }
 
 // В специализации шаблона PrintValue для типа bool параметр value передаётся
 // по константной ссылке, как и в основном шаблоне.
 template <>
 void PrintValue<bool>(const bool& value, const PrintContext& ctx) {
-    ctx.out << (value ? "true"sv : "false"sv);
+    ctx.out.Write(value ? "true"sv : "false"sv);
 }
 
 template <>
 void PrintValue<Array>(const Array& nodes, const PrintContext& ctx) {
-    std::ostream& out = ctx.out;
-    out << "[\n"sv;
+    Writer& out = ctx.out;
+    out.Write("[\n"sv);
     bool first = true;
     auto inner_ctx = ctx.Indented();
     for (const Node& node : nodes) {
         if (first) {
             first = false;
         } else {
-            out << ",\n"sv;
+            out.Write(",\n"sv);
         }
         inner_ctx.PrintIndent();
         PrintNode(node, inner_ctx);
     }
-    out.put('\n');
+    out.Put('\n');
     ctx.PrintIndent();
-    out.put(']');
+    out.Put(']');
 }
 
 template <>
 void PrintValue<Dict>(const Dict& nodes, const PrintContext& ctx) {
-    std::ostream& out = ctx.out;
-    out << "{\n"sv;
+    Writer& out = ctx.out;
+    out.Write("{\n"sv);
     bool first = true;
     auto inner_ctx = ctx.Indented();
     for (const auto& [key, node] : nodes) {
         if (first) {
             first = false;
         } else {
-            out << ",\n"sv;
+            out.Write(",\n"sv);
         }
         inner_ctx.PrintIndent();
         PrintString(key, ctx.out);
-        out << ": "sv;
+        out.Write(": "sv);
         PrintNode(node, inner_ctx);
     }
-    out.put('\n');
+    out.Put('\n');
     ctx.PrintIndent();
-    out.put('}');
+    out.Put('}');
 }
 
 void PrintNode(const Node& node, const PrintContext& ctx) {
-    std::visit(
-        [&ctx](const auto& value) {
-            PrintValue(value, ctx);
-        },
-        node.GetValue());
+    switch (node.GetType()) {
+        case Node::Type::NUL:
+            PrintValue(nullptr, ctx);
+            break;
+        case Node::Type::ARRAY:
+            PrintValue(node.AsArray(), ctx);
+            break;
+        case Node::Type::DICT:
+            PrintValue(node.AsDict(), ctx);
+            break;
+        case Node::Type::BOOL:
+            PrintValue(node.AsBool(), ctx);
+            break;
+        case Node::Type::INT:
+            PrintValue(node.AsInt(), ctx);
+            break;
+        case Node::Type::DOUBLE:
+            PrintValue(node.AsDouble(), ctx);
+            break;
+        case Node::Type::STRING:
+            PrintValue(node.AsString(), ctx);
+            break;
+    }
 }
 
 }  // namespace
 
+Dict::Dict(std::vector<value_type> entries)
+    : entries_(std::move(entries)) {
+    const auto by_key = [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first < rhs.first;
+    };
+    if (!std::is_sorted(entries_.begin(), entries_.end(), by_key)) {
+        std::sort(entries_.begin(), entries_.end(), by_key);
+    }
+    const auto duplicate = std::adjacent_find(entries_.begin(), entries_.end(), [](const value_type& lhs, const value_type& rhs) {
+        return lhs.first == rhs.first;
+    });
+    if (duplicate != entries_.end()) {
+        throw std::invalid_argument("Duplicate key '"s + duplicate->first + "' have been found");
+    }
+}
+
 Document Load(std::istream& input) {
     return Document{LoadNode(input)};
 }
 
 void Print(const Document& doc, std::ostream& output) {
-    PrintNode(doc.GetRoot(), PrintContext{output});
+    Writer writer(output);
+    // Отрицательная точность у %g означает точность по умолчанию
+    const std::streamsize stream_precision = output.precision();
+    const int precision = stream_precision < 0 ? 6 : static_cast<int>(std::min<std::streamsize>(stream_precision, 1000));
+    PrintNode(doc.GetRoot(), PrintContext{writer, HasPlainNumberFormat(output), precision});
 }
 
 }  // namespace json
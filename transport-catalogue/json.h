@@ -1,15 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <cstdint>
 #include <iostream>
-#include <map>
+#include <stdexcept>
 #include <string>
-#include <variant>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace json {
 
 class Node;
-using Dict = std::map<std::string, Node>;
+class Dict;
 using Array = std::vector<Node>;
 
 class ParsingError : public std::runtime_error {
@@ -17,27 +20,77 @@ public:
     using runtime_error::runtime_error;
 };
 
-class Node final
-    : private std::variant<std::nullptr_t, Array, Dict, bool, int, double, std::string> {
+// Узел занимает 16 байт: тег и значение, строки, массивы и словари лежат в куче.
+// Объект хранит тип отдельно, поэтому копирование и сравнение не проходят через std::visit
+class Node final {
 public:
-    using variant::variant;
-	using Value = variant;
-    
-    Node(Value value) : variant(std::move(value)) {}
+    enum class Type : uint8_t {
+        NUL,
+        ARRAY,
+        DICT,
+        BOOL,
+        INT,
+        DOUBLE,
+        STRING,
+    };
+
+    Node() noexcept {}
+    Node(std::nullptr_t) noexcept : Node() {}
+    Node(Array value);
+    Node(Dict value);
+    Node(bool value) noexcept : type_(Type::BOOL) {
+        payload_.boolean = value;
+    }
+    Node(int value) noexcept : type_(Type::INT) {
+        payload_.integer = value;
+    }
+    Node(double value) noexcept : type_(Type::DOUBLE) {
+        payload_.real = value;
+    }
+    Node(std::string value);
+    Node(const char* value) : Node(std::string(value)) {}
+
+    Node(const Node& other);
+    Node(Node&& other) noexcept : type_(other.type_), payload_(other.payload_) {
+        other.type_ = Type::NUL;
+    }
+    Node& operator=(const Node& other) {
+        if (this != &other) {
+            Node copy(other);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+    Node& operator=(Node&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            type_ = other.type_;
+            payload_ = other.payload_;
+            other.type_ = Type::NUL;
+        }
+        return *this;
+    }
+    ~Node() {
+        Reset();
+    }
+
+    Type GetType() const {
+        return type_;
+    }
 
     bool IsInt() const {
-        return std::holds_alternative<int>(*this);
+        return type_ == Type::INT;
     }
     int AsInt() const {
         using namespace std::literals;
         if (!IsInt()) {
             throw std::logic_error("Not an int"s);
         }
-        return std::get<int>(*this);
+        return payload_.integer;
     }
 
     bool IsPureDouble() const {
-        return std::holds_alternative<double>(*this);
+        return type_ == Type::DOUBLE;
     }
     bool IsDouble() const {
         return IsInt() || IsPureDouble();
@@ -47,11 +100,11 @@ public:
         if (!IsDouble()) {
             throw std::logic_error("Not a double"s);
         }
-        return IsPureDouble() ? std::get<double>(*this) : AsInt();
+        return IsPureDouble() ? payload_.real : payload_.integer;
     }
 
     bool IsBool() const {
-        return std::holds_alternative<bool>(*this);
+        return type_ == Type::BOOL;
     }
     bool AsBool() const {
         using namespace std::literals;
@@ -59,15 +112,15 @@ public:
             throw std::logic_error("Not a bool"s);
         }
 
-        return std::get<bool>(*this);
+        return payload_.boolean;
     }
 
     bool IsNull() const {
-        return std::holds_alternative<std::nullptr_t>(*this);
+        return type_ == Type::NUL;
     }
 
     bool IsArray() const {
-        return std::holds_alternative<Array>(*this);
+        return type_ == Type::ARRAY;
     }
     const Array& AsArray() const {
         using namespace std::literals;
@@ -75,11 +128,14 @@ public:
             throw std::logic_error("Not an array"s);
         }
 
-        return std::get<Array>(*this);
+        return *payload_.array;
+    }
+    Array& AsArray() {
+        return const_cast<Array&>(std::as_const(*this).AsArray());
     }
 
     bool IsString() const {
-        return std::holds_alternative<std::string>(*this);
+        return type_ == Type::STRING;
     }
     const std::string& AsString() const {
         using namespace std::literals;
@@ -87,11 +143,11 @@ public:
             throw std::logic_error("Not a string"s);
         }
 
-        return std::get<std::string>(*this);
+        return *payload_.string;
     }
 
     bool IsDict() const {
-        return std::holds_alternative<Dict>(*this);
+        return type_ == Type::DICT;
     }
     const Dict& AsDict() const {
         using namespace std::literals;
@@ -99,21 +155,186 @@ public:
             throw std::logic_error("Not a dict"s);
         }
 
-        return std::get<Dict>(*this);
+        return *payload_.dict;
     }
+    Dict& AsDict() {
+        return const_cast<Dict&>(std::as_const(*this).AsDict());
+    }
+
+    bool operator==(const Node& rhs) const;
+
+private:
+    void Reset() noexcept;
+
+    union Payload {
+        bool boolean;
+        int integer;
+        double real;
+        std::string* string;
+        Array* array;
+        Dict* dict;
+    };
+
+    Type type_ = Type::NUL;
+    Payload payload_{};
+};
+
+// Словарь — плоский массив пар, упорядоченный по ключу, с интерфейсом std::map для чтения.
+// Обход идёт в том же порядке, что и у std::map. Небольшие словари ищутся перебором,
+// большие — двоичным поиском
+class Dict {
+public:
+    using key_type = std::string;
+    using mapped_type = Node;
+    using value_type = std::pair<std::string, Node>;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    static constexpr size_t LINEAR_SEARCH_SIZE = 8;
 
-    bool operator==(const Node& rhs) const {
-        return GetValue() == rhs.GetValue();
+    Dict() = default;
+    // Пары упорядочиваются по ключу; при повторяющемся ключе — std::invalid_argument
+    explicit Dict(std::vector<value_type> entries);
+
+    const_iterator begin() const {
+        return entries_.begin();
+    }
+    const_iterator end() const {
+        return entries_.end();
+    }
+    size_t size() const {
+        return entries_.size();
+    }
+    bool empty() const {
+        return entries_.empty();
+    }
+    size_t capacity() const {
+        return entries_.capacity();
     }
 
-    const Value& GetValue() const {
-        return *this;
+    const_iterator find(std::string_view key) const {
+        const auto it = LowerBound(key);
+        return it != entries_.end() && it->first == key ? it : entries_.end();
     }
-    Value& GetValue() {
-        return *this;
+    size_t count(std::string_view key) const {
+        return find(key) != entries_.end() ? 1 : 0;
+    }
+    const Node& at(std::string_view key) const {
+        const auto it = find(key);
+        if (it == entries_.end()) {
+            throw std::out_of_range("Dict::at");
+        }
+        return it->second;
+    }
+
+    Node& operator[](std::string key) {
+        auto it = LowerBound(key);
+        if (it == entries_.end() || it->first != key) {
+            it = entries_.emplace(it, std::move(key), Node{});
+        }
+        return entries_[it - entries_.cbegin()].second;
+    }
+    std::pair<const_iterator, bool> emplace(std::string key, Node value) {
+        const auto it = LowerBound(key);
+        if (it != entries_.end() && it->first == key) {
+            return {it, false};
+        }
+        return {entries_.emplace(it, std::move(key), std::move(value)), true};
     }
+
+    bool operator==(const Dict& rhs) const {
+        return entries_ == rhs.entries_;
+    }
+
+private:
+    const_iterator LowerBound(std::string_view key) const {
+        if (entries_.size() <= LINEAR_SEARCH_SIZE) {
+            auto it = entries_.begin();
+            while (it != entries_.end() && std::string_view(it->first) < key) {
+                ++it;
+            }
+            return it;
+        }
+        return std::lower_bound(entries_.begin(), entries_.end(), key, [](const value_type& entry, std::string_view value) {
+            return std::string_view(entry.first) < value;
+        });
+    }
+
+    std::vector<value_type> entries_;
 };
 
+inline Node::Node(Array value)
+    : type_(Type::ARRAY) {
+    payload_.array = new Array(std::move(value));
+}
+
+inline Node::Node(Dict value)
+    : type_(Type::DICT) {
+    payload_.dict = new Dict(std::move(value));
+}
+
+inline Node::Node(std::string value)
+    : type_(Type::STRING) {
+    payload_.string = new std::string(std::move(value));
+}
+
+inline Node::Node(const Node& other)
+    : type_(other.type_)
+    , payload_(other.payload_) {
+    switch (type_) {
+        case Type::ARRAY:
+            payload_.array = new Array(*other.payload_.array);
+            break;
+        case Type::DICT:
+            payload_.dict = new Dict(*other.payload_.dict);
+            break;
+        case Type::STRING:
+            payload_.string = new std::string(*other.payload_.string);
+            break;
+        default:
+            break;
+    }
+}
+
+inline void Node::Reset() noexcept {
+    switch (type_) {
+        case Type::ARRAY:
+            delete payload_.array;
+            break;
+        case Type::DICT:
+            delete payload_.dict;
+            break;
+        case Type::STRING:
+            delete payload_.string;
+            break;
+        default:
+            break;
+    }
+    type_ = Type::NUL;
+}
+
+inline bool Node::operator==(const Node& rhs) const {
+    if (type_ != rhs.type_) {
+        return false;
+    }
+    switch (type_) {
+        case Type::NUL:
+            return true;
+        case Type::ARRAY:
+            return *payload_.array == *rhs.payload_.array;
+        case Type::DICT:
+            return *payload_.dict == *rhs.payload_.dict;
+        case Type::BOOL:
+            return payload_.boolean == rhs.payload_.boolean;
+        case Type::INT:
+            return payload_.integer == rhs.payload_.integer;
+        case Type::DOUBLE:
+            return payload_.real == rhs.payload_.real;
+        case Type::STRING:
+            return *payload_.string == *rhs.payload_.string;
+    }
+    return false;
+}
+
 inline bool operator!=(const Node& lhs, const Node& rhs) {
     return !(lhs == rhs);
 }
@@ -1,6 +1,5 @@
 #include "json_builder.h"
 #include <exception>
-#include <variant>
 #include <utility>
 
 using namespace std::literals;
@@ -20,19 +19,19 @@ Node Builder::Build() {
 }
 
 Builder::DictValueContext Builder::Key(std::string key) {
-    Node::Value& host_value = GetCurrentValue();
+    Node& host_value = GetCurrentValue();
     
-    if (!std::holds_alternative<Dict>(host_value)) {
+    if (!host_value.IsDict()) {
         throw std::logic_error("Key() outside a dict"s);
     }
     
     nodes_stack_.push_back(
-        &std::get<Dict>(host_value)[std::move(key)]
+        &host_value.AsDict()[std::move(key)]
     );
     return BaseContext{*this};
 }
 
-Builder::BaseContext Builder::Value(Node::Value value) {
+Builder::BaseContext Builder::Value(Node value) {
     AddObject(std::move(value), true);
     return *this;
 }
@@ -48,7 +47,7 @@ Builder::ArrayItemContext Builder::StartArray() {
 }
 
 Builder::BaseContext Builder::EndDict() {
-    if (!std::holds_alternative<Dict>(GetCurrentValue())) {
+    if (!GetCurrentValue().IsDict()) {
         throw std::logic_error("EndDict() outside a dict"s);
     }
     nodes_stack_.pop_back();
@@ -56,35 +55,35 @@ Builder::BaseContext Builder::EndDict() {
 }
 
 Builder::BaseContext Builder::EndArray() {
-    if (!std::holds_alternative<Array>(GetCurrentValue())) {
+    if (!GetCurrentValue().IsArray()) {
         throw std::logic_error("EndDict() outside an array"s);
     }
     nodes_stack_.pop_back();
     return *this;
 }   
 
-Node::Value& Builder::GetCurrentValue() {
+Node& Builder::GetCurrentValue() {
     if (nodes_stack_.empty()) {
         throw std::logic_error("Attempt to change finalized JSON"s);
     }
-    return nodes_stack_.back()->GetValue();
+    return *nodes_stack_.back();
 }
 
-const Node::Value& Builder::GetCurrentValue() const {
+const Node& Builder::GetCurrentValue() const {
     return const_cast<Builder*>(this)->GetCurrentValue();
 }
 
 void Builder::AssertNewObjectContext() const {
-    if (!std::holds_alternative<std::nullptr_t>(GetCurrentValue())) {
+    if (!GetCurrentValue().IsNull()) {
         throw std::logic_error("New object in wrong context"s);
     }
 }
 
-void Builder::AddObject(Node::Value value, bool one_shot) {
-    Node::Value& host_value = GetCurrentValue();
-    if (std::holds_alternative<Array>(host_value)) {
+void Builder::AddObject(Node value, bool one_shot) {
+    Node& host_value = GetCurrentValue();
+    if (host_value.IsArray()) {
         Node& node
-            = std::get<Array>(host_value).emplace_back(std::move(value));
+            = host_value.AsArray().emplace_back(std::move(value));
         if (!one_shot) {
             nodes_stack_.push_back(&node);
         }
@@ -17,7 +17,7 @@ public:
     Builder();
     Node Build();
     DictValueContext Key(std::string key);
-    BaseContext Value(Node::Value value);
+    BaseContext Value(Node value);
     DictItemContext StartDict();
     ArrayItemContext StartArray();
     BaseContext EndDict();
@@ -27,11 +27,11 @@ private:
     Node root_;
     std::vector<Node*> nodes_stack_;
 
-    Node::Value& GetCurrentValue();
-    const Node::Value& GetCurrentValue() const;
+    Node& GetCurrentValue();
+    const Node& GetCurrentValue() const;
     
     void AssertNewObjectContext() const;
-    void AddObject(Node::Value value, bool one_shot);
+    void AddObject(Node value, bool one_shot);
      
     
     class BaseContext {
@@ -43,7 +43,7 @@ private:
         DictValueContext Key(std::string key) {
             return builder_.Key(std::move(key));
         }
-        BaseContext Value(Node::Value value) {
+        BaseContext Value(Node value) {
             return builder_.Value(std::move(value));
         }
         DictItemContext StartDict() {
@@ -65,7 +65,7 @@ private:
     class DictValueContext : public BaseContext {
     public:
         DictValueContext(BaseContext base) : BaseContext(base) {}
-        DictItemContext Value(Node::Value value) { return BaseContext::Value(std::move(value)); }
+        DictItemContext Value(Node value) { return BaseContext::Value(std::move(value)); }
         Node Build() = delete;
         DictValueContext Key(std::string key) = delete;
         BaseContext EndDict() = delete;
@@ -76,7 +76,7 @@ private:
     public:
         DictItemContext(BaseContext base) : BaseContext(base) {}
         Node Build() = delete;
-        BaseContext Value(Node::Value value) = delete;
+        BaseContext Value(Node value) = delete;
         BaseContext EndArray() = delete;
         DictItemContext StartDict() = delete;
         ArrayItemContext StartArray() = delete;
@@ -85,7 +85,7 @@ private:
     class ArrayItemContext : public BaseContext {
     public:
         ArrayItemContext(BaseContext base) : BaseContext(base) {}
-        ArrayItemContext Value(Node::Value value) { return BaseContext::Value(std::move(value)); }
+        ArrayItemContext Value(Node value) { return BaseContext::Value(std::move(value)); }
         Node Build() = delete;
         DictValueContext Key(std::string key) = delete;
         BaseContext EndDict() = delete;
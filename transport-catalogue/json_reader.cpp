@@ -1,6 +1,10 @@
 #include "json_reader.h"
 #include "json_builder.h"
+#include "metrics.h"
+#include "stage_profiler.h"
+#include "tracing.h"
 
+#include <cmath>
 #include <iostream>
 
 const json::Node& JsonReader::GetStatRequests() const {
@@ -24,6 +28,37 @@ const json::Node& JsonReader::GetRoutingSettings() const {
     return input_.GetRoot().AsDict().at("routing_settings");
 }
 
+namespace {
+
+// Строки, массивы и словари узла лежат в отдельных блоках кучи
+memory::Usage EstimateNodeMemoryUsage(const json::Node& node) {
+    memory::Usage result;
+    if (node.IsArray()) {
+        result += {sizeof(json::Array), 1};
+        result += memory::EstimateVectorBuffer(node.AsArray());
+        for (const auto& item : node.AsArray()) {
+            result += EstimateNodeMemoryUsage(item);
+        }
+    } else if (node.IsDict()) {
+        result += {sizeof(json::Dict), 1};
+        result += {node.AsDict().capacity() * sizeof(json::Dict::value_type), node.AsDict().capacity() > 0 ? 1u : 0u};
+        for (const auto& [key, value] : node.AsDict()) {
+            result += memory::EstimateString(key);
+            result += EstimateNodeMemoryUsage(value);
+        }
+    } else if (node.IsString()) {
+        result += {sizeof(std::string), 1};
+        result += memory::EstimateString(node.AsString());
+    }
+    return result;
+}
+
+} // namespace
+
+memory::Usage JsonReader::GetDocumentMemoryUsage() const {
+    return EstimateNodeMemoryUsage(input_.GetRoot());
+}
+
 void JsonReader::FillCatalogue(transport::Catalogue& catalogue) {
     if (input_.GetRoot().AsDict().count("base_requests") > 0) {
     const auto& base_requests = input_.GetRoot().AsDict().at("base_requests").AsArray();
@@ -47,10 +82,11 @@ void JsonReader::FillCatalogue(transport::Catalogue& catalogue) {
         const auto& type = map_request.at("type").AsString();
         if (type == "Bus") {
             auto [bus_number, stops, circular_route] = FillRoute(map_request, catalogue);
-            catalogue.AddBus(bus_number, stops, circular_route);
+            catalogue.AddBus(bus_number, stops, circular_route, FillSchedule(map_request));
         }
     }
 }
+    catalogue.BuildIndexes();
 }
 
 std::tuple<std::string_view, geo::Coordinates, std::map<std::string_view, int>> JsonReader::FillStop(const json::Dict& map_request) const {
@@ -84,6 +120,21 @@ std::tuple<std::string_view, std::vector<const transport::Stop*>, bool> JsonRead
     return std::make_tuple(bus_number, stops, circular_route);
 }
 
+std::optional<transport::BusSchedule> JsonReader::FillSchedule(const json::Dict& map_request) const {
+    if (!map_request.count("schedule")) {
+        return std::nullopt;
+    }
+    const auto& schedule = map_request.at("schedule").AsDict();
+    transport::BusSchedule result;
+    result.first_departure = schedule.at("first_departure").AsInt();
+    result.last_departure = schedule.at("last_departure").AsInt();
+    result.interval = schedule.at("interval").AsInt();
+    if (result.interval <= 0 || result.last_departure < result.first_departure) {
+        throw std::logic_error("Invalid bus schedule");
+    }
+    return result;
+}
+
 renderer::MapRenderer JsonReader::FillRenderSettings(const json::Node& settings) const {
     json::Dict map_request = settings.AsDict();
     renderer::RenderSettings render_settings;
@@ -149,27 +200,196 @@ svg::Color JsonReader::ParseColor(const json::Node& color_node) const {
 transport::TransportRouter::Settings JsonReader::FillRoutingSettings(const json::Node& settings) const {
     const auto& wait_time = settings.AsDict().at("bus_wait_time").AsInt();
     const auto& velocity = settings.AsDict().at("bus_velocity").AsDouble();
-    return transport::TransportRouter::Settings{wait_time, velocity};
+    transport::GraphModel graph_model = transport::GraphModel::PAIRWISE;
+    if (settings.AsDict().count("graph_model")) {
+        const auto& model = settings.AsDict().at("graph_model").AsString();
+        if (model == "chained") {
+            graph_model = transport::GraphModel::CHAINED;
+        } else if (model != "pairwise") {
+            throw std::logic_error("Unsupported graph model");
+        }
+    }
+    transport::AllPairsAlgorithm all_pairs_algorithm = transport::AllPairsAlgorithm::CLASSIC;
+    if (settings.AsDict().count("all_pairs_algorithm")) {
+        const auto& algorithm = settings.AsDict().at("all_pairs_algorithm").AsString();
+        if (algorithm == "blocked") {
+            all_pairs_algorithm = transport::AllPairsAlgorithm::BLOCKED;
+        } else if (algorithm != "classic") {
+            throw std::logic_error("Unsupported all pairs algorithm");
+        }
+    }
+    return transport::TransportRouter::Settings{wait_time, velocity, graph_model, all_pairs_algorithm};
+}
+
+size_t JsonReader::FillRouteCacheCapacity(const json::Node& settings) const {
+    if (!settings.IsDict() || !settings.AsDict().count("route_cache_capacity")) {
+        return DEFAULT_ROUTE_CACHE_CAPACITY;
+    }
+    const int capacity = settings.AsDict().at("route_cache_capacity").AsInt();
+    if (capacity < 0) {
+        throw std::logic_error("Negative route cache capacity");
+    }
+    return static_cast<size_t>(capacity);
 }
 
 void JsonReader::PrintStatRequests(const json::Node& stat_requests, RequestHandler& req_hand) const {
+    const std::vector<StatRequest> requests = DecodeStatRequests(stat_requests.AsArray(), req_hand);
     json::Array result;
-    for (auto& request : stat_requests.AsArray()) {
-        const auto& map_request = request.AsDict();       
-        if (map_request.at("type").AsString() == "Stop") {
-           result.push_back(PrintStop(map_request, req_hand).AsDict());
+    for (const auto& request : requests) {
+        json::Node response = HandleStatRequest(request, req_hand);
+        if (!response.IsNull()) {
+            result.push_back(std::move(response));
+        }
+    }
+    json::Print(json::Document{result}, std::cout);
+}
+
+std::vector<StatRequest> JsonReader::DecodeStatRequests(const json::Array& stat_requests, const RequestHandler& req_hand) const {
+    std::vector<StatRequest> result;
+    result.reserve(stat_requests.size());
+    for (const auto& request : stat_requests) {
+        result.push_back(DecodeStatRequest(request.AsDict(), req_hand));
+    }
+    return result;
+}
+
+void JsonReader::DecodeStops(const json::Node& stops, const RequestHandler& req_hand, std::vector<const transport::Stop*>& result) const {
+    if (stops.IsString()) {
+        result.push_back(req_hand.FindStop(stops.AsString()));
+        return;
+    }
+    for (const auto& stop : stops.AsArray()) {
+        result.push_back(req_hand.FindStop(stop.AsString()));
+    }
+}
+
+StatRequest JsonReader::DecodeStatRequest(const json::Dict& map_request, const RequestHandler& req_hand) const {
+    StatRequest request;
+    request.kind = ParseStatRequestKind(map_request.at("type").AsString());
+    if (request.kind == StatRequestKind::UNKNOWN) {
+        return request;
+    }
+    request.id = map_request.at("id").AsInt();
+    switch (request.kind) {
+    case StatRequestKind::STOP:
+        request.from = req_hand.FindStop(map_request.at("name").AsString());
+        break;
+    case StatRequestKind::BUS:
+        request.bus = req_hand.FindBus(map_request.at("name").AsString());
+        break;
+    case StatRequestKind::ROUTE:
+        request.from = req_hand.FindStop(map_request.at("from").AsString());
+        request.to = req_hand.FindStop(map_request.at("to").AsString());
+        request.pareto = map_request.count("pareto") && map_request.at("pareto").AsBool();
+        break;
+    case StatRequestKind::ROUTE_MATRIX:
+        DecodeStops(map_request.at("from"), req_hand, request.matrix_stops);
+        request.from_count = request.matrix_stops.size();
+        DecodeStops(map_request.at("to"), req_hand, request.matrix_stops);
+        break;
+    case StatRequestKind::ISOCHRONE:
+        request.from = req_hand.FindStop(map_request.at("from").AsString());
+        request.time = map_request.at("max_time").AsDouble();
+        if (!std::isfinite(request.time) || request.time < 0.0) {
+            throw std::logic_error("Isochrone requires non-negative max_time");
         }
-        if (map_request.at("type").AsString() == "Bus") {
-           result.push_back(PrintRoute(map_request, req_hand).AsDict());
+        request.render_map = map_request.count("render_map") && map_request.at("render_map").AsBool();
+        break;
+    case StatRequestKind::NEAREST_STOPS:
+        request.min_coordinates = {map_request.at("latitude").AsDouble(), map_request.at("longitude").AsDouble()};
+        if (map_request.count("count")) {
+            request.count = static_cast<size_t>(std::max(map_request.at("count").AsInt(), 0));
         }
-        if (map_request.at("type").AsString() == "Map") {
-           result.push_back(PrintMap(map_request, req_hand).AsDict());
+        if (map_request.count("radius")) {
+            request.radius = map_request.at("radius").AsDouble();
         }
-        if (map_request.at("type").AsString() == "Route") {
-           result.push_back(PrintRouting(map_request, req_hand).AsDict());
+        if (!request.count && !request.radius) {
+            throw std::logic_error("NearestStops requires count or radius");
         }
+        break;
+    case StatRequestKind::STOPS_IN_AREA:
+        request.min_coordinates = {map_request.at("min_latitude").AsDouble(), map_request.at("min_longitude").AsDouble()};
+        request.max_coordinates = {map_request.at("max_latitude").AsDouble(), map_request.at("max_longitude").AsDouble()};
+        break;
+    case StatRequestKind::AUTOCOMPLETE:
+        request.prefix = map_request.at("prefix").AsString();
+        request.limit = map_request.count("limit") ? static_cast<size_t>(std::max(map_request.at("limit").AsInt(), 0)) : DEFAULT_AUTOCOMPLETE_LIMIT;
+        if (map_request.count("kind")) {
+            const std::string& kind_name = map_request.at("kind").AsString();
+            if (kind_name == "Stop") {
+                request.name_kind = transport::NameKind::STOP;
+            } else if (kind_name == "Bus") {
+                request.name_kind = transport::NameKind::BUS;
+            } else {
+                throw std::logic_error("Unsupported autocomplete kind");
+            }
+        }
+        break;
+    case StatRequestKind::EARLIEST_ARRIVAL:
+        request.from = req_hand.FindStop(map_request.at("from").AsString());
+        request.to = req_hand.FindStop(map_request.at("to").AsString());
+        request.time = map_request.at("departure_time").AsDouble();
+        break;
+    case StatRequestKind::MAP:
+    case StatRequestKind::UNKNOWN:
+        break;
     }
-    json::Print(json::Document{result}, std::cout);
+    return request;
+}
+
+namespace {
+
+struct RequestMetrics {
+    metrics::Counter& requests;
+    metrics::ConcurrentHistogram& latency;
+};
+
+const RequestMetrics& GetRequestMetrics(StatRequestKind kind) {
+    static const std::vector<RequestMetrics> known_kinds = [] {
+        auto& registry = metrics::Registry::Instance();
+        std::vector<RequestMetrics> result;
+        for (size_t i = 0; i < STAT_REQUEST_KIND_COUNT; ++i) {
+            const std::string labels = std::string("type=\"") + GetStatRequestTypeName(static_cast<StatRequestKind>(i)) + "\"";
+            result.push_back({registry.GetCounter("tc_stat_requests_total", labels),
+                              registry.GetHistogram("tc_stat_request_duration_seconds", labels)});
+        }
+        return result;
+    }();
+    return known_kinds[static_cast<size_t>(kind)];
+}
+
+} // namespace
+
+json::Node JsonReader::HandleStatRequest(const StatRequest& request, RequestHandler& req_hand) const {
+    const auto& request_metrics = GetRequestMetrics(request.kind);
+    request_metrics.requests.Add();
+    metrics::ScopedTimer timer(request_metrics.latency);
+    TC_TRACE_SCOPE(GetStatRequestTypeName(request.kind));
+    switch (request.kind) {
+    case StatRequestKind::STOP:
+        return PrintStop(request, req_hand);
+    case StatRequestKind::BUS:
+        return PrintRoute(request, req_hand);
+    case StatRequestKind::MAP:
+        return PrintMap(request, req_hand);
+    case StatRequestKind::ROUTE:
+        return PrintRouting(request, req_hand);
+    case StatRequestKind::ROUTE_MATRIX:
+        return PrintRouteMatrix(request, req_hand);
+    case StatRequestKind::ISOCHRONE:
+        return PrintIsochrone(request, req_hand);
+    case StatRequestKind::NEAREST_STOPS:
+        return PrintNearestStops(request, req_hand);
+    case StatRequestKind::STOPS_IN_AREA:
+        return PrintStopsInArea(request, req_hand);
+    case StatRequestKind::AUTOCOMPLETE:
+        return PrintAutocomplete(request, req_hand);
+    case StatRequestKind::EARLIEST_ARRIVAL:
+        return PrintEarliestArrival(request, req_hand);
+    case StatRequestKind::UNKNOWN:
+        break;
+    }
+    return nullptr;
 }
 
 const json::Node GetErrorMessage(const int id) {
@@ -177,46 +397,48 @@ const json::Node GetErrorMessage(const int id) {
             return json::Builder{}.StartDict().Key("request_id").Value(id).Key("error_message").Value("not found").EndDict().Build();
         }
 
-const json::Node JsonReader::PrintStop(const json::Dict& map_request, RequestHandler& req_hand) const {
+const json::Node JsonReader::PrintStop(const StatRequest& request, RequestHandler& req_hand) const {
     json::Node result;
-    const std::string& stop_name = map_request.at("name").AsString();
-    const int id = map_request.at("id").AsInt();
-    if (!req_hand.SearchStopName(stop_name)) {
-       result = GetErrorMessage(id);
+    if (!request.from) {
+       result = GetErrorMessage(request.id);
     }
     else {
         json::Array buses;
-        for (auto& bus : req_hand.GetBusesOnStop(stop_name)) {
-            buses.push_back(bus);
+        for (const auto* bus : req_hand.GetBusesOnStop(request.from)) {
+            buses.push_back(bus->number);
         }
-        result = json::Builder{}.StartDict().Key("request_id").Value(id).Key("buses").Value(buses).EndDict().Build();
+        result = json::Builder{}.StartDict().Key("request_id").Value(request.id).Key("buses").Value(buses).EndDict().Build();
     }
     return result;
 }
 
-const json::Node JsonReader::PrintRoute(const json::Dict& map_request, RequestHandler& req_hand) const {
+const json::Node JsonReader::PrintRoute(const StatRequest& request, RequestHandler& req_hand) const {
     json::Node result;
-    const std::string& route_number = map_request.at("name").AsString();
-    const int id = map_request.at("id").AsInt();
-    if (!req_hand.SearchBusNumber(route_number)) {
-        result = GetErrorMessage(id);
+    if (!request.bus) {
+        result = GetErrorMessage(request.id);
     }
     else {
-        const auto& info = req_hand.GetBusStat(route_number);
-        result = json::Builder{}.StartDict().Key("request_id").Value(id).Key("curvature").Value(info->curvature)
-            .Key("route_length").Value(info->route_length).Key("stop_count").Value(static_cast<int>(info->stops_count))
-            .Key("unique_stop_count").Value(static_cast<int>(info->unique_stops_count)).EndDict().Build();
+        const auto info = req_hand.GetBusStat(request.bus);
+        result = json::Builder{}.StartDict().Key("request_id").Value(request.id).Key("curvature").Value(info.curvature)
+            .Key("route_length").Value(info.route_length).Key("stop_count").Value(static_cast<int>(info.stops_count))
+            .Key("unique_stop_count").Value(static_cast<int>(info.unique_stops_count)).EndDict().Build();
     }
     return result;
 }
 
-const json::Node JsonReader::PrintMap(const json::Dict& map_request, RequestHandler& req_hand) const {
+const json::Node JsonReader::PrintMap(const StatRequest& request, RequestHandler& req_hand) const {
     json::Node result;
-    const int id = map_request.at("id").AsInt();
+    static metrics::ConcurrentHistogram& render_duration = metrics::Registry::Instance().GetHistogram("tc_map_render_duration_seconds");
+    static metrics::Counter& output_bytes = metrics::Registry::Instance().GetCounter("tc_map_output_bytes_total");
     std::ostringstream out;
-    svg::Document map = req_hand.RenderMap();
-    map.Render(out);
-    result = json::Builder{}.StartDict().Key("request_id").Value(id).Key("map").Value(out.str()).EndDict().Build();      
+    {
+        metrics::ScopedTimer timer(render_duration);
+        profiling::ScopedStage stage("map_render");
+        svg::Document map = req_hand.RenderMap();
+        map.Render(out);
+    }
+    output_bytes.Add(out.str().size());
+    result = json::Builder{}.StartDict().Key("request_id").Value(request.id).Key("map").Value(out.str()).EndDict().Build();      
     return result;
 }
 
@@ -226,34 +448,194 @@ const json::Node JsonReader::CreateRouteItem(const double& time, const std::stri
             .Key("type").Value(type).EndDict().Build();
 }
 
-const json::Node JsonReader::PrintRouting(const json::Dict& map_request, RequestHandler& req_hand) const {
+CachedRoute JsonReader::CreateRouteItems(const std::vector<transport::RouteId>& edges, const transport::RouteGraph& graph) const {
+    CachedRoute route;
+    // В цепочечной модели одна поездка состоит из посадки, нескольких перегонов и высадки
+    std::optional<double> ride_time;
+    auto finish_ride = [&]() {
+        if (ride_time) {
+            route.items.emplace_back(CreateRouteItem(*ride_time, "bus"));
+            ride_time.reset();
+        }
+    };
+    for (auto& edge_id : edges) {
+        const auto& edge_info = graph.GetEdge(edge_id);
+        const double wait_time = transport::ToMinutes(edge_info.weight);
+        if (edge_info.type == "Stop") {
+            finish_ride();
+            route.items.emplace_back(CreateRouteItem(wait_time, "stop_name"));
+        }
+        else if (edge_info.type == "Board") {
+            finish_ride();
+            ride_time = wait_time;
+        }
+        else if (edge_info.type == "Alight") {
+            finish_ride();
+        }
+        else if (ride_time) {
+            *ride_time += wait_time;
+        }
+        else {
+            route.items.emplace_back(CreateRouteItem(wait_time, "bus"));
+        }
+        route.total_time += wait_time;
+    }
+    finish_ride();
+    return route;
+}
+
+const json::Node JsonReader::PrintRouting(const StatRequest& request, RequestHandler& req_hand) const {
+    if (request.pareto) {
+        return PrintParetoRouting(request, req_hand);
+    }
     json::Node result;
-    const int id = map_request.at("id").AsInt();
-    const std::string_view stop_from = map_request.at("from").AsString();
-    const std::string_view stop_to = map_request.at("to").AsString();
-    const auto& routing = req_hand.GetRouting(stop_from, stop_to);
-    if (!routing) {
-        result = GetErrorMessage(id);
+    if (!request.from || !request.to) {
+        return GetErrorMessage(request.id);
     }
-    else {
-        const auto& graph = req_hand.GetRouterGraph();
-        json::Array items;
-        double total_time = 0.0;
-        for (auto& edge_id : routing.value().edges) {
-            const auto& edge_info = graph.GetEdge(edge_id);
-            auto wait_time = edge_info.weight;
-            if (edge_info.type == "Stop") {
-                items.emplace_back(CreateRouteItem(wait_time, "stop_name"));
-            }
-            else {
-                items.emplace_back(CreateRouteItem(wait_time, "bus"));
+    auto cached = req_hand.FindCachedRouting(request.from, request.to);
+    if (!cached) {
+        const auto& routing = req_hand.GetRouting(request.from, request.to);
+        if (!routing) {
+            return GetErrorMessage(request.id);
+        }
+        cached = req_hand.CacheRouting(request.from, request.to, CreateRouteItems(routing.value().edges, req_hand.GetRouterGraph()));
+    }
+    result = json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("total_time").Value(cached->total_time)
+            .Key("items").Value(cached->items).EndDict().Build();
+    return result;
+}
+
+const json::Node JsonReader::PrintParetoRouting(const StatRequest& request, RequestHandler& req_hand) const {
+    if (!request.from || !request.to) {
+        return GetErrorMessage(request.id);
+    }
+    const auto pareto_routes = req_hand.GetParetoRoutings(request.from, request.to);
+    if (pareto_routes.empty()) {
+        return GetErrorMessage(request.id);
+    }
+    json::Array routes;
+    for (const auto& pareto_route : pareto_routes) {
+        auto route = CreateRouteItems(pareto_route.edges, req_hand.GetRouterGraph());
+        routes.emplace_back(json::Builder{}.StartDict()
+                .Key("total_time").Value(route.total_time)
+                .Key("boardings").Value(static_cast<int>(pareto_route.count))
+                .Key("items").Value(std::move(route.items)).EndDict().Build());
+    }
+    return json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("routes").Value(std::move(routes)).EndDict().Build();
+}
+
+const json::Node JsonReader::PrintRouteMatrix(const StatRequest& request, RequestHandler& req_hand) const {
+    for (const auto* stop : request.matrix_stops) {
+        if (!stop) {
+            return GetErrorMessage(request.id);
+        }
+    }
+    const auto middle = request.matrix_stops.begin() + request.from_count;
+    const std::vector<const transport::Stop*> stops_from(request.matrix_stops.begin(), middle);
+    const std::vector<const transport::Stop*> stops_to(middle, request.matrix_stops.end());
+    json::Array total_times;
+    for (const auto& row : req_hand.GetTravelTimes(stops_from, stops_to)) {
+        json::Array times;
+        for (const auto& time : row) {
+            if (time) {
+                times.emplace_back(*time);
+            } else {
+                times.emplace_back(nullptr);
             }
-            total_time += wait_time;
         }
-        result = json::Builder{}.StartDict()
-                .Key("request_id").Value(id)
-                .Key("total_time").Value(total_time)
-                .Key("items").Value(items).EndDict().Build();
+        total_times.emplace_back(std::move(times));
+    }
+    return json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("total_times").Value(std::move(total_times)).EndDict().Build();
+}
+
+const json::Node JsonReader::PrintIsochrone(const StatRequest& request, RequestHandler& req_hand) const {
+    if (!request.from) {
+        return GetErrorMessage(request.id);
+    }
+    const auto reachable_stops = req_hand.GetReachableStops(request.from, request.time);
+    json::Array stops;
+    for (const auto& [stop, time] : reachable_stops) {
+        stops.emplace_back(json::Builder{}.StartDict()
+                .Key("stop_name").Value(stop->name)
+                .Key("time").Value(time).EndDict().Build());
+    }
+    json::Dict result = json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("stops").Value(std::move(stops)).EndDict().Build().AsDict();
+    if (request.render_map) {
+        std::ostringstream out;
+        req_hand.RenderIsochrone(reachable_stops, request.time).Render(out);
+        result.emplace("map", out.str());
     }
     return result;
 }
+
+const json::Node JsonReader::PrintNearestStops(const StatRequest& request, RequestHandler& req_hand) const {
+    json::Array stops;
+    for (const auto& [stop, distance] : req_hand.FindNearestStops(request.min_coordinates, request.count, request.radius)) {
+        stops.emplace_back(json::Builder{}.StartDict()
+                .Key("stop_name").Value(stop->name)
+                .Key("distance").Value(distance).EndDict().Build());
+    }
+    return json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("stops").Value(std::move(stops)).EndDict().Build();
+}
+
+const json::Node JsonReader::PrintStopsInArea(const StatRequest& request, RequestHandler& req_hand) const {
+    json::Array stops;
+    for (const auto* stop : req_hand.FindStopsInArea(request.min_coordinates, request.max_coordinates)) {
+        stops.emplace_back(stop->name);
+    }
+    return json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("stops").Value(std::move(stops)).EndDict().Build();
+}
+
+const json::Node JsonReader::PrintAutocomplete(const StatRequest& request, RequestHandler& req_hand) const {
+    json::Array matches;
+    for (const auto& [name, match_kind] : req_hand.FindNamesByPrefix(request.prefix, request.limit, request.name_kind)) {
+        matches.emplace_back(json::Builder{}.StartDict()
+                .Key("name").Value(std::string(name))
+                .Key("type").Value(match_kind == transport::NameKind::STOP ? "Stop" : "Bus").EndDict().Build());
+    }
+    return json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("matches").Value(std::move(matches)).EndDict().Build();
+}
+
+const json::Node JsonReader::PrintEarliestArrival(const StatRequest& request, RequestHandler& req_hand) const {
+    if (!request.from || !request.to) {
+        return GetErrorMessage(request.id);
+    }
+    const auto journey = req_hand.FindEarliestArrival(request.from, request.to, request.time);
+    if (!journey) {
+        return GetErrorMessage(request.id);
+    }
+    json::Array items;
+    double time = journey->departure_time;
+    for (const auto& leg : journey->legs) {
+        items.emplace_back(json::Builder{}.StartDict()
+                .Key("type").Value("Wait")
+                .Key("stop_name").Value(leg.from->name)
+                .Key("time").Value(leg.departure_time - time).EndDict().Build());
+        items.emplace_back(json::Builder{}.StartDict()
+                .Key("type").Value("Bus")
+                .Key("bus").Value(leg.bus->number)
+                .Key("span_count").Value(static_cast<int>(leg.span_count))
+                .Key("departure_time").Value(leg.departure_time)
+                .Key("time").Value(leg.arrival_time - leg.departure_time).EndDict().Build());
+        time = leg.arrival_time;
+    }
+    return json::Builder{}.StartDict()
+            .Key("request_id").Value(request.id)
+            .Key("arrival_time").Value(journey->arrival_time)
+            .Key("total_time").Value(journey->arrival_time - journey->departure_time)
+            .Key("items").Value(std::move(items)).EndDict().Build();
+}
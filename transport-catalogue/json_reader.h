@@ -2,11 +2,15 @@
 
 #include "json.h"
 #include "map_renderer.h"
+#include "memory_usage.h"
 #include "request_handler.h"
+#include "stat_request.h"
 #include "transport_catalogue.h"
 
 #include <iostream>
 
+inline constexpr size_t DEFAULT_AUTOCOMPLETE_LIMIT = 10;
+
 class JsonReader {
 public:
     JsonReader(std::istream& input)
@@ -16,6 +20,8 @@ public:
     const json::Node& GetStatRequests() const;
     const json::Node& GetRenderSettings() const;
     const json::Node& GetRoutingSettings() const;
+    // Объём DOM входного документа, который хранится всё время работы
+    memory::Usage GetDocumentMemoryUsage() const;
 
 
     void FillCatalogue(transport::Catalogue& catalogue);
@@ -26,13 +32,26 @@ public:
     void SetColorPalette(renderer::RenderSettings& settings, const json::Dict& v) const;
     svg::Color ParseColor(const json::Node& color_node) const;
     transport::TransportRouter::Settings FillRoutingSettings(const json::Node& settings) const;
+    size_t FillRouteCacheCapacity(const json::Node& settings) const;
 
     void PrintStatRequests(const json::Node& stat_requests, RequestHandler& rh) const;
-    const json::Node PrintRoute(const json::Dict& map_request, RequestHandler& rh) const;
-    const json::Node PrintStop(const json::Dict& map_request, RequestHandler& rh) const;
-    const json::Node PrintMap(const json::Dict& map_request, RequestHandler& rh) const;
+    // Разбор stat_requests до обработки: обработчики работают с типизированными запросами
+    // и не обращаются к DOM и индексам имён
+    std::vector<StatRequest> DecodeStatRequests(const json::Array& stat_requests, const RequestHandler& rh) const;
+    StatRequest DecodeStatRequest(const json::Dict& map_request, const RequestHandler& rh) const;
+    json::Node HandleStatRequest(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintRoute(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintStop(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintMap(const StatRequest& request, RequestHandler& rh) const;
     const json::Node CreateRouteItem(const double& time, const std::string& type) const;
-    const json::Node PrintRouting(const json::Dict& map_request, RequestHandler& rh) const;
+    const json::Node PrintRouting(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintParetoRouting(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintRouteMatrix(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintIsochrone(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintNearestStops(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintStopsInArea(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintAutocomplete(const StatRequest& request, RequestHandler& rh) const;
+    const json::Node PrintEarliestArrival(const StatRequest& request, RequestHandler& rh) const;
 
 private:
     json::Document input_;
@@ -41,4 +60,7 @@ private:
     std::tuple<std::string_view, geo::Coordinates, std::map<std::string_view, int>> FillStop(const json::Dict& map_request) const;
     void FillStopDistances(transport::Catalogue& catalogue, const json::Dict& map_request) const;
     std::tuple<std::string_view, std::vector<const transport::Stop*>, bool> FillRoute(const json::Dict& map_request, transport::Catalogue& catalogue) const;
+    std::optional<transport::BusSchedule> FillSchedule(const json::Dict& map_request) const;
+    void DecodeStops(const json::Node& stops, const RequestHandler& rh, std::vector<const transport::Stop*>& result) const;
+    CachedRoute CreateRouteItems(const std::vector<transport::RouteId>& edges, const transport::RouteGraph& graph) const;
 };
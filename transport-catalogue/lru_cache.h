@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cache {
+
+// Потокобезопасный LRU-кэш, разбитый на независимые сегменты со своими мьютексами.
+// Значения хранятся в shared_ptr, поэтому найденный элемент остаётся валидным
+// даже после вытеснения из кэша.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+        size_t capacity = 0;
+
+        double GetHitRate() const {
+            const uint64_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+        }
+    };
+
+    explicit LruCache(size_t capacity, size_t shard_count = 16);
+
+    std::shared_ptr<const Value> Get(const Key& key) const;
+    std::shared_ptr<const Value> Put(const Key& key, Value value);
+    void Clear();
+
+    size_t GetCapacity() const;
+    Stats GetStats() const;
+
+private:
+    using Entry = std::pair<Key, std::shared_ptr<const Value>>;
+    using EntryList = std::list<Entry>;
+
+    struct Shard {
+        std::mutex mutex;
+        EntryList entries;
+        std::unordered_map<Key, typename EntryList::iterator, Hash> index;
+        size_t capacity = 0;
+    };
+
+    Shard& GetShard(const Key& key) const;
+
+    size_t capacity_;
+    std::unique_ptr<Shard[]> shards_;
+    size_t shard_count_;
+    mutable std::atomic<uint64_t> hits_ = 0;
+    mutable std::atomic<uint64_t> misses_ = 0;
+    std::atomic<uint64_t> evictions_ = 0;
+};
+
+template <typename Key, typename Value, typename Hash>
+LruCache<Key, Value, Hash>::LruCache(size_t capacity, size_t shard_count)
+    : capacity_(capacity)
+    , shard_count_(std::max<size_t>(1, std::min(shard_count, capacity)))
+{
+    shards_ = std::make_unique<Shard[]>(shard_count_);
+    for (size_t i = 0; i < shard_count_; ++i) {
+        shards_[i].capacity = capacity_ / shard_count_ + (i < capacity_ % shard_count_ ? 1 : 0);
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+typename LruCache<Key, Value, Hash>::Shard& LruCache<Key, Value, Hash>::GetShard(const Key& key) const {
+    return shards_[Hash{}(key) % shard_count_];
+}
+
+template <typename Key, typename Value, typename Hash>
+std::shared_ptr<const Value> LruCache<Key, Value, Hash>::Get(const Key& key) const {
+    if (capacity_ == 0) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Shard& shard = GetShard(key);
+    std::lock_guard guard(shard.mutex);
+    const auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return it->second->second;
+}
+
+template <typename Key, typename Value, typename Hash>
+std::shared_ptr<const Value> LruCache<Key, Value, Hash>::Put(const Key& key, Value value) {
+    auto stored = std::make_shared<const Value>(std::move(value));
+    if (capacity_ == 0) {
+        return stored;
+    }
+    Shard& shard = GetShard(key);
+    std::lock_guard guard(shard.mutex);
+    if (const auto it = shard.index.find(key); it != shard.index.end()) {
+        it->second->second = stored;
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        return stored;
+    }
+    if (shard.entries.size() >= shard.capacity) {
+        shard.index.erase(shard.entries.back().first);
+        shard.entries.pop_back();
+        evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+    shard.entries.emplace_front(key, stored);
+    shard.index.emplace(key, shard.entries.begin());
+    return stored;
+}
+
+template <typename Key, typename Value, typename Hash>
+void LruCache<Key, Value, Hash>::Clear() {
+    for (size_t i = 0; i < shard_count_; ++i) {
+        std::lock_guard guard(shards_[i].mutex);
+        shards_[i].entries.clear();
+        shards_[i].index.clear();
+    }
+}
+
+template <typename Key, typename Value, typename Hash>
+size_t LruCache<Key, Value, Hash>::GetCapacity() const {
+    return capacity_;
+}
+
+template <typename Key, typename Value, typename Hash>
+typename LruCache<Key, Value, Hash>::Stats LruCache<Key, Value, Hash>::GetStats() const {
+    Stats stats;
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.capacity = capacity_;
+    for (size_t i = 0; i < shard_count_; ++i) {
+        std::lock_guard guard(shards_[i].mutex);
+        stats.size += shards_[i].entries.size();
+    }
+    return stats;
+}
+
+}  // namespace cache
@@ -1,20 +1,178 @@
 #include "json_reader.h"
+#include "memory_usage.h"
+#include "metrics.h"
 #include "request_handler.h"
+#include "stage_profiler.h"
+#include "tracing.h"
+#include "transport_snapshot.h"
+#include "wire_protocol.h"
 
-int main() {
-    transport::Catalogue catalogue;
-    JsonReader json_doc(std::cin);
+#include <fstream>
+#include <string_view>
+
+namespace {
+
+// --metrics=stderr или --metrics=<путь к файлу>
+void DumpMetrics(std::string_view target) {
+    if (target == "stderr") {
+        metrics::Registry::Instance().Dump(std::cerr);
+        return;
+    }
+    std::ofstream out{std::string(target)};
+    metrics::Registry::Instance().Dump(out);
+}
+
+// Переводит stat_requests входного документа в кадры двоичного протокола
+void WriteBinaryRequests(const std::vector<StatRequest>& requests, std::string_view path) {
+    std::ofstream out{std::string(path), std::ios::binary};
+    std::string payload;
+    for (const auto& request : requests) {
+        payload.clear();
+        wire::EncodeStatRequest(request, payload);
+        wire::WriteFrame(out, payload);
+    }
+}
+
+// Печатает кадры ответов двоичного протокола тем же JSON-массивом, что и обработка stat_requests
+void PrintBinaryResponses(std::istream& input, std::ostream& output) {
+    std::string payload;
+    json::Array responses;
+    while (wire::ReadFrame(input, payload)) {
+        json::Node response = wire::DecodeResponse(payload);
+        if (!response.IsNull()) {
+            responses.push_back(std::move(response));
+        }
+    }
+    json::Print(json::Document{std::move(responses)}, output);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    using namespace std::literals;
+    std::string_view metrics_target;
+    std::string_view trace_path;
+    std::string_view binary_requests_path;
+    std::string_view write_binary_requests_path;
+    std::string_view print_binary_responses_path;
+    bool profile_stages = false;
+    bool memory_report = false;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        if (arg.substr(0, "--metrics="sv.size()) == "--metrics="sv) {
+            metrics_target = arg.substr("--metrics="sv.size());
+        } else if (arg.substr(0, "--trace="sv.size()) == "--trace="sv) {
+            trace_path = arg.substr("--trace="sv.size());
+        } else if (arg.substr(0, "--binary-requests="sv.size()) == "--binary-requests="sv) {
+            binary_requests_path = arg.substr("--binary-requests="sv.size());
+        } else if (arg.substr(0, "--write-binary-requests="sv.size()) == "--write-binary-requests="sv) {
+            write_binary_requests_path = arg.substr("--write-binary-requests="sv.size());
+        } else if (arg.substr(0, "--print-binary-responses="sv.size()) == "--print-binary-responses="sv) {
+            print_binary_responses_path = arg.substr("--print-binary-responses="sv.size());
+        } else if (arg == "--perf-stages"sv) {
+            profile_stages = true;
+        } else if (arg == "--memory-report"sv) {
+            memory_report = true;
+        }
+    }
+    if (!print_binary_responses_path.empty()) {
+        // Только расшифровка ответов: входной документ не читается
+        std::ifstream responses{std::string(print_binary_responses_path), std::ios::binary};
+        if (!responses) {
+            std::cerr << "Cannot open " << print_binary_responses_path << std::endl;
+            return 1;
+        }
+        try {
+            PrintBinaryResponses(responses, std::cout);
+        } catch (const wire::ProtocolError& e) {
+            std::cerr << "Broken binary responses stream: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+    if (profile_stages) {
+        profiling::StageProfiler::Instance().Enable();
+    }
+
+    auto catalogue = std::make_shared<transport::Catalogue>();
+    JsonReader json_doc = [] {
+        TC_TRACE_SCOPE("LoadJson");
+        profiling::ScopedStage stage("parse");
+        return JsonReader(std::cin);
+    }();
     
-    json_doc.FillCatalogue(catalogue);
+    {
+        TC_TRACE_SCOPE("FillCatalogue");
+        profiling::ScopedStage stage("catalogue_fill");
+        json_doc.FillCatalogue(*catalogue);
+    }
     
     const auto& stat_requests = json_doc.GetStatRequests();
     const auto& render_settings = json_doc.GetRenderSettings();
     const auto& routing_settings = json_doc.GetRoutingSettings();
-    const auto& renderer = json_doc.FillRenderSettings(render_settings);
+    const auto renderer = [&] {
+        TC_TRACE_SCOPE("FillRenderSettings");
+        profiling::ScopedStage stage("render_settings");
+        return json_doc.FillRenderSettings(render_settings);
+    }();
     const auto& full_routing = json_doc.FillRoutingSettings(routing_settings);
-    const transport::TransportRouter router(full_routing, catalogue);
     
-    RequestHandler req_hand(catalogue, renderer, router);
+    transport::SnapshotHolder snapshots;
+    {
+        TC_TRACE_SCOPE("BuildRouter");
+        snapshots.Publish(std::move(catalogue), full_routing);
+    }
+    const auto snapshot = snapshots.Acquire();
     
-    json_doc.PrintStatRequests(stat_requests, req_hand);
+    RequestHandler req_hand(*snapshot, renderer, json_doc.FillRouteCacheCapacity(routing_settings));
+
+    if (memory_report) {
+        memory::Report report;
+        report.push_back({"json.dom", json_doc.GetDocumentMemoryUsage()});
+        snapshot->catalogue->CollectMemoryUsage(report);
+        snapshot->router->CollectMemoryUsage(report);
+        memory::PrintReport(report, std::cerr);
+    }
+    
+    if (!write_binary_requests_path.empty()) {
+        WriteBinaryRequests(json_doc.DecodeStatRequests(stat_requests.AsArray(), req_hand), write_binary_requests_path);
+    }
+
+    if (!binary_requests_path.empty()) {
+        // Запросы и ответы в двоичном протоколе; stat_requests входного документа не обрабатываются
+        TC_TRACE_SCOPE("ServeBinaryRequests");
+        profiling::ScopedStage stage("requests");
+        std::ifstream requests{std::string(binary_requests_path), std::ios::binary};
+        if (!requests) {
+            std::cerr << "Cannot open " << binary_requests_path << std::endl;
+            return 1;
+        }
+        try {
+            wire::ServeStatRequests(requests, std::cout, json_doc, req_hand);
+        } catch (const wire::ProtocolError& e) {
+            std::cerr << "Broken binary requests stream: " << e.what() << std::endl;
+            return 1;
+        }
+    } else {
+        TC_TRACE_SCOPE("PrintStatRequests");
+        profiling::ScopedStage stage("requests");
+        json_doc.PrintStatRequests(stat_requests, req_hand);
+    }
+
+    if (!metrics_target.empty()) {
+        req_hand.UpdateMetrics();
+        DumpMetrics(metrics_target);
+    }
+    if (profile_stages) {
+        profiling::StageProfiler::Instance().PrintReport(std::cerr);
+    }
+    if (!trace_path.empty()) {
+#ifdef TC_ENABLE_TRACING
+        if (!TC_TRACE_WRITE(std::string(trace_path))) {
+            std::cerr << "Cannot write trace to " << trace_path << std::endl;
+        }
+#else
+        std::cerr << "Tracing is disabled, rebuild with -DTC_ENABLE_TRACING" << std::endl;
+#endif
+    }
 }
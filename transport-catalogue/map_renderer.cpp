@@ -6,10 +6,10 @@ bool IsZero(double value) {
     return std::abs(value) < EPSILON;
 }
 
-std::vector<svg::Polyline> MapRenderer::RenderRoute(const std::map<std::string_view, const transport::Bus*>& buses, const SphereProjector& proj) const {
+std::vector<svg::Polyline> MapRenderer::RenderRoute(const std::vector<const transport::Bus*>& buses, const SphereProjector& proj) const {
     std::vector<svg::Polyline> results;
     size_t color_index = 0;
-    for (const auto& [bus_number, bus] : buses) {
+    for (const auto* bus : buses) {
         if (bus->stops.empty()) continue;
         std::vector<const transport::Stop*> stops_for_route(bus->stops.begin(), bus->stops.end());
         if (!bus->is_roundtrip) {
@@ -29,10 +29,10 @@ std::vector<svg::Polyline> MapRenderer::RenderRoute(const std::map<std::string_v
     return results;
 }
 
-std::vector<svg::Text> MapRenderer::RenderBusName(const std::map<std::string_view, const transport::Bus*>& buses, const SphereProjector& proj) const {
+std::vector<svg::Text> MapRenderer::RenderBusName(const std::vector<const transport::Bus*>& buses, const SphereProjector& proj) const {
     std::vector<svg::Text> results;
     size_t color_index = 0;
-    for (const auto& [bus_number, bus] : buses) {
+    for (const auto* bus : buses) {
         if (bus->stops.empty()) continue;
         auto create_text = [&](const transport::Stop* stop) -> std::pair<svg::Text, svg::Text> {
             svg::Text text, text_substrate;
@@ -68,9 +68,9 @@ std::vector<svg::Text> MapRenderer::RenderBusName(const std::map<std::string_vie
     return results;
 }
 
-std::vector<svg::Circle> MapRenderer::RenderStopCoordinates(const std::map<std::string_view, const transport::Stop*>& stops, const SphereProjector& proj) const {
+std::vector<svg::Circle> MapRenderer::RenderStopCoordinates(const std::vector<const transport::Stop*>& stops, const SphereProjector& proj) const {
     std::vector<svg::Circle> results;
-    for (const auto& [stop_name, stop] : stops) {
+    for (const auto* stop : stops) {
         results.push_back(svg::Circle()
                           .SetCenter(proj(stop->coordinates))
                           .SetRadius(render_settings_.stop_radius)
@@ -79,9 +79,9 @@ std::vector<svg::Circle> MapRenderer::RenderStopCoordinates(const std::map<std::
     return results;
 }
 
-std::vector<svg::Text> MapRenderer::RenderStopNames(const std::map<std::string_view, const transport::Stop*>& stops, const SphereProjector& proj) const {
+std::vector<svg::Text> MapRenderer::RenderStopNames(const std::vector<const transport::Stop*>& stops, const SphereProjector& proj) const {
     std::vector<svg::Text> results;
-    for (const auto& [stop_name, stop] : stops) {
+    for (const auto* stop : stops) {
         svg::Text text, text_substrate;
         text.SetPosition(proj(stop->coordinates))
              .SetOffset(render_settings_.stop_label_offset)
@@ -103,18 +103,27 @@ text_substrate.SetFillColor(render_settings_.underlayer_color)
     return results;
 }
 
-svg::Document MapRenderer::RenderMap(const std::map<std::string_view, const transport::Bus*>& buses) const {
-    svg::Document result;
+SphereProjector MapRenderer::MakeProjector(const std::vector<const transport::Bus*>& buses) const {
     std::vector<geo::Coordinates> coordinates;
-    std::map<std::string_view, const transport::Stop*> all_stops;
-    for (const auto& [bus_number, bus] : buses) {
-        if (bus->stops.empty()) continue;
+    for (const auto* bus : buses) {
         for (const auto stop : bus->stops) {
             coordinates.push_back(stop->coordinates);
-            all_stops[stop->name] = stop;
         }
     }
-    SphereProjector proj(coordinates.begin(), coordinates.end(), render_settings_.width, render_settings_.height, render_settings_.padding);
+    return SphereProjector(coordinates.begin(), coordinates.end(), render_settings_.width, render_settings_.height, render_settings_.padding);
+}
+
+svg::Document MapRenderer::RenderMap(const std::vector<const transport::Bus*>& buses) const {
+    svg::Document result;
+    std::vector<const transport::Stop*> all_stops;
+    for (const auto* bus : buses) {
+        all_stops.insert(all_stops.end(), bus->stops.begin(), bus->stops.end());
+    }
+    std::sort(all_stops.begin(), all_stops.end(), [](const transport::Stop* lhs, const transport::Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    all_stops.erase(std::unique(all_stops.begin(), all_stops.end()), all_stops.end());
+    const SphereProjector proj = MakeProjector(buses);
     
     for (const auto& line : RenderRoute(buses, proj)) result.Add(line);
     for (const auto& label : RenderBusName(buses, proj)) result.Add(label);
@@ -124,4 +133,18 @@ svg::Document MapRenderer::RenderMap(const std::map<std::string_view, const tran
     return result;
 }
 
+svg::Document MapRenderer::RenderIsochrone(const std::vector<const transport::Bus*>& buses,
+                                           const std::vector<std::pair<const transport::Stop*, double>>& reachable_stops, double max_time) const {
+    svg::Document result = RenderMap(buses);
+    const SphereProjector proj = MakeProjector(buses);
+    for (const auto& [stop, time] : reachable_stops) {
+        const double closeness = IsZero(max_time) ? 1.0 : 1.0 - time / max_time;
+        result.Add(svg::Circle()
+                   .SetCenter(proj(stop->coordinates))
+                   .SetRadius(render_settings_.stop_radius * 2)
+                   .SetFillColor(svg::Rgba(255, 0, 0, 0.2 + 0.6 * closeness)));
+    }
+    return result;
+}
+
 } // namespace renderer
@@ -100,15 +100,19 @@ public:
         : render_settings_(render_settings)
     {}
     
-    std::vector<svg::Polyline> RenderRoute(const std::map<std::string_view, const transport::Bus*>& buses, const SphereProjector& proj) const;
-    std::vector<svg::Text> RenderBusName(const std::map<std::string_view, const transport::Bus*>& buses, const SphereProjector& proj) const;
-    std::vector<svg::Circle> RenderStopCoordinates(const std::map<std::string_view, const transport::Stop*>& stops, const SphereProjector& proj) const;
-    std::vector<svg::Text> RenderStopNames(const std::map<std::string_view, const transport::Stop*>& stops, const SphereProjector& proj) const;
+    std::vector<svg::Polyline> RenderRoute(const std::vector<const transport::Bus*>& buses, const SphereProjector& proj) const;
+    std::vector<svg::Text> RenderBusName(const std::vector<const transport::Bus*>& buses, const SphereProjector& proj) const;
+    std::vector<svg::Circle> RenderStopCoordinates(const std::vector<const transport::Stop*>& stops, const SphereProjector& proj) const;
+    std::vector<svg::Text> RenderStopNames(const std::vector<const transport::Stop*>& stops, const SphereProjector& proj) const;
     
-    svg::Document RenderMap(const std::map<std::string_view, const transport::Bus*>& buses) const;
+    svg::Document RenderMap(const std::vector<const transport::Bus*>& buses) const;
+    svg::Document RenderIsochrone(const std::vector<const transport::Bus*>& buses,
+                                  const std::vector<std::pair<const transport::Stop*, double>>& reachable_stops, double max_time) const;
     
 private:
     const RenderSettings render_settings_;
+
+    SphereProjector MakeProjector(const std::vector<const transport::Bus*>& buses) const;
 };
 
 } // namespace renderer
@@ -0,0 +1,48 @@
+#include "memory_usage.h"
+
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+namespace memory {
+
+namespace {
+
+std::string FormatMebibytes(size_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << static_cast<double>(bytes) / (1024.0 * 1024.0);
+    return out.str();
+}
+
+} // namespace
+
+void PrintReport(const Report& report, std::ostream& out) {
+    Usage total;
+    for (const auto& entry : report) {
+        total += entry.usage;
+    }
+    auto print_row = [&out, &total](const std::string& name, const Usage& usage) {
+        std::ostringstream share;
+        share << std::fixed << std::setprecision(1) << (total.bytes == 0 ? 0.0 : 100.0 * usage.bytes / total.bytes);
+        out << std::left << std::setw(28) << name << std::right << std::setw(16) << usage.bytes << std::setw(12)
+            << FormatMebibytes(usage.bytes) << std::setw(14) << usage.allocations << std::setw(8) << share.str() << '\n';
+    };
+    out << std::left << std::setw(28) << "subsystem" << std::right << std::setw(16) << "bytes" << std::setw(12) << "MiB"
+        << std::setw(14) << "allocations" << std::setw(8) << "%" << '\n';
+    for (const auto& entry : report) {
+        print_row(entry.subsystem, entry.usage);
+    }
+    print_row("total", total);
+#if defined(__linux__)
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        out << "peak RSS: " << FormatMebibytes(static_cast<size_t>(usage.ru_maxrss) * 1024) << " MiB\n";
+    }
+#endif
+    out.flush();
+}
+
+}  // namespace memory
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <deque>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace memory {
+
+// Структурная оценка занятой кучи: суммируются полезные размеры блоков, которые выделяют
+// контейнеры libstdc++, без служебных заголовков malloc и выравнивания
+struct Usage {
+    size_t bytes = 0;
+    size_t allocations = 0;
+
+    Usage& operator+=(const Usage& other) {
+        bytes += other.bytes;
+        allocations += other.allocations;
+        return *this;
+    }
+};
+
+inline Usage operator+(Usage lhs, const Usage& rhs) {
+    return lhs += rhs;
+}
+
+struct ReportEntry {
+    std::string subsystem;
+    Usage usage;
+};
+
+using Report = std::vector<ReportEntry>;
+
+// Таблица по подсистемам с долей от общего объёма и пиковым RSS процесса для сравнения
+void PrintReport(const Report& report, std::ostream& out);
+
+// Короткие строки хранятся внутри объекта и кучу не занимают
+inline Usage EstimateString(const std::string& value) {
+    const char* data = value.data();
+    const char* object = reinterpret_cast<const char*>(&value);
+    if (data >= object && data < object + sizeof(value)) {
+        return {};
+    }
+    return {value.capacity() + 1, 1};
+}
+
+template <typename T>
+Usage EstimateVectorBuffer(const std::vector<T>& values) {
+    if (values.capacity() == 0) {
+        return {};
+    }
+    return {values.capacity() * sizeof(T), 1};
+}
+
+// Блоки deque по 512 байт и массив указателей на них
+template <typename T>
+Usage EstimateDequeBuffer(const std::deque<T>& values) {
+    const size_t per_block = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+    const size_t blocks = values.size() / per_block + 1;
+    const size_t map_size = std::max<size_t>(8, blocks + 2);
+    return {blocks * per_block * sizeof(T) + map_size * sizeof(void*), blocks + 1};
+}
+
+// Узел красно-чёрного дерева: цвет и три указателя, затем значение
+template <typename Container>
+Usage EstimateTreeNodes(const Container& container) {
+    constexpr size_t NODE_HEADER = sizeof(int) > sizeof(void*) ? sizeof(int) : sizeof(void*);
+    return {container.size() * (NODE_HEADER + 3 * sizeof(void*) + sizeof(typename Container::value_type)), container.size()};
+}
+
+// Узел хеш-таблицы: указатель на следующий, значение и закешированный хеш; отдельно массив корзин
+template <typename Container>
+Usage EstimateHashNodes(const Container& container) {
+    const size_t node_size = sizeof(void*) + sizeof(typename Container::value_type) + sizeof(size_t);
+    const size_t buckets = container.bucket_count() > 1 ? container.bucket_count() : 0;
+    return {container.size() * node_size + buckets * sizeof(void*), container.size() + (buckets > 0 ? 1 : 0)};
+}
+
+}  // namespace memory
@@ -0,0 +1,149 @@
+#include "metrics.h"
+
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace metrics {
+
+namespace {
+
+std::string WithLabels(const std::string& name, const std::string& labels, const std::string& extra = {}) {
+    if (labels.empty() && extra.empty()) {
+        return name;
+    }
+    std::string result = name + "{" + labels;
+    if (!labels.empty() && !extra.empty()) {
+        result += ",";
+    }
+    return result + extra + "}";
+}
+
+// Границы корзин при выгрузке: 1-2.5-5 от 1 мкс до 10 с
+const std::vector<double>& GetExportBounds() {
+    static const std::vector<double> bounds = [] {
+        std::vector<double> result;
+        for (double decade = 1e-6; decade < 10.0; decade *= 10.0) {
+            result.push_back(decade);
+            result.push_back(decade * 2.5);
+            result.push_back(decade * 5.0);
+        }
+        result.push_back(10.0);
+        return result;
+    }();
+    return bounds;
+}
+
+void DumpHistogram(std::ostream& out, const std::string& name, const std::string& labels, const Histogram& histogram) {
+    size_t bucket = 0;
+    uint64_t cumulative = 0;
+    for (const double bound : GetExportBounds()) {
+        const auto bound_ns = static_cast<uint64_t>(bound * 1e9);
+        while (bucket < Histogram::BUCKET_COUNT && Histogram::GetBucketUpperBound(bucket) <= bound_ns) {
+            cumulative += histogram.GetBucketCount(bucket++);
+        }
+        std::ostringstream le;
+        le << "le=\"" << bound << '"';
+        out << WithLabels(name + "_bucket", labels, le.str()) << ' ' << cumulative << '\n';
+    }
+    out << WithLabels(name + "_bucket", labels, "le=\"+Inf\"") << ' ' << histogram.GetCount() << '\n';
+    out << WithLabels(name + "_sum", labels) << ' ' << static_cast<double>(histogram.GetSum()) / 1e9 << '\n';
+    out << WithLabels(name + "_count", labels) << ' ' << histogram.GetCount() << '\n';
+}
+
+} // namespace
+
+size_t GetThreadStripe() {
+    thread_local const size_t stripe = std::hash<std::thread::id>{}(std::this_thread::get_id()) % STRIPE_COUNT;
+    return stripe;
+}
+
+uint64_t Counter::Get() const {
+    uint64_t result = 0;
+    for (const auto& stripe : stripes_) {
+        result += stripe.value.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+void ConcurrentHistogram::Record(uint64_t value) {
+    Stripe& stripe = stripes_[GetThreadStripe()];
+    stripe.buckets[Histogram::GetBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    stripe.sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t max = stripe.max.load(std::memory_order_relaxed);
+    while (max < value && !stripe.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram ConcurrentHistogram::Collect() const {
+    Histogram result;
+    for (const auto& stripe : stripes_) {
+        for (size_t i = 0; i < Histogram::BUCKET_COUNT; ++i) {
+            if (const uint64_t count = stripe.buckets[i].load(std::memory_order_relaxed)) {
+                result.MergeBucket(i, count);
+            }
+        }
+        result.MergeTotals(stripe.sum.load(std::memory_order_relaxed), stripe.max.load(std::memory_order_relaxed));
+    }
+    return result;
+}
+
+Registry& Registry::Instance() {
+    static Registry registry;
+    return registry;
+}
+
+Counter& Registry::GetCounter(const std::string& name, const std::string& labels) {
+    std::lock_guard guard(mutex_);
+    auto& metric = counter_families_[name][labels];
+    if (!metric) {
+        metric = &counters_.emplace_back();
+    }
+    return *metric;
+}
+
+Gauge& Registry::GetGauge(const std::string& name, const std::string& labels) {
+    std::lock_guard guard(mutex_);
+    auto& metric = gauge_families_[name][labels];
+    if (!metric) {
+        metric = &gauges_.emplace_back();
+    }
+    return *metric;
+}
+
+ConcurrentHistogram& Registry::GetHistogram(const std::string& name, const std::string& labels) {
+    std::lock_guard guard(mutex_);
+    auto& metric = histogram_families_[name][labels];
+    if (!metric) {
+        metric = &histograms_.emplace_back();
+    }
+    return *metric;
+}
+
+void Registry::Dump(std::ostream& out) const {
+    std::lock_guard guard(mutex_);
+    const auto precision = out.precision(15);
+    for (const auto& [name, family] : counter_families_) {
+        out << "# TYPE " << name << " counter\n";
+        for (const auto& [labels, counter] : family) {
+            out << WithLabels(name, labels) << ' ' << counter->Get() << '\n';
+        }
+    }
+    for (const auto& [name, family] : gauge_families_) {
+        out << "# TYPE " << name << " gauge\n";
+        for (const auto& [labels, gauge] : family) {
+            out << WithLabels(name, labels) << ' ' << gauge->Get() << '\n';
+        }
+    }
+    for (const auto& [name, family] : histogram_families_) {
+        out << "# TYPE " << name << " histogram\n";
+        for (const auto& [labels, histogram] : family) {
+            DumpHistogram(out, name, labels, histogram->Collect());
+        }
+    }
+    out.precision(precision);
+    out.flush();
+}
+
+}  // namespace metrics
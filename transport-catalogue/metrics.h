@@ -0,0 +1,112 @@
+#pragma once
+
+#include "histogram.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+namespace metrics {
+
+// Счётчики и гистограммы разбиты на полосы, каждый поток пишет в свою полосу
+// атомарными операциями без блокировок; при выгрузке полосы суммируются
+inline constexpr size_t STRIPE_COUNT = 8;
+
+size_t GetThreadStripe();
+
+class Counter {
+public:
+    void Add(uint64_t value = 1) {
+        stripes_[GetThreadStripe()].value.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    uint64_t Get() const;
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> value = 0;
+    };
+    std::array<Stripe, STRIPE_COUNT> stripes_;
+};
+
+class Gauge {
+public:
+    void Set(double value) {
+        value_.store(value, std::memory_order_relaxed);
+    }
+
+    double Get() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<double> value_ = 0.0;
+};
+
+class ConcurrentHistogram {
+public:
+    void Record(uint64_t value);
+    Histogram Collect() const;
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<uint64_t>, Histogram::BUCKET_COUNT> buckets{};
+        std::atomic<uint64_t> sum = 0;
+        std::atomic<uint64_t> max = 0;
+    };
+    std::array<Stripe, STRIPE_COUNT> stripes_;
+};
+
+// Реестр метрик. Метрики создаются один раз и живут до конца программы,
+// поэтому ссылки на них можно сохранять и обновлять без обращения к реестру
+class Registry {
+public:
+    static Registry& Instance();
+
+    Counter& GetCounter(const std::string& name, const std::string& labels = {});
+    Gauge& GetGauge(const std::string& name, const std::string& labels = {});
+    // Значения гистограмм записываются в наносекундах, выгружаются в секундах
+    ConcurrentHistogram& GetHistogram(const std::string& name, const std::string& labels = {});
+
+    // Текстовый формат Prometheus
+    void Dump(std::ostream& out) const;
+
+private:
+    template <typename Metric>
+    using Family = std::map<std::string, std::map<std::string, Metric*>>;
+
+    mutable std::mutex mutex_;
+    std::deque<Counter> counters_;
+    std::deque<Gauge> gauges_;
+    std::deque<ConcurrentHistogram> histograms_;
+    Family<Counter> counter_families_;
+    Family<Gauge> gauge_families_;
+    Family<ConcurrentHistogram> histogram_families_;
+};
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ConcurrentHistogram& histogram)
+        : histogram_(histogram)
+        , start_(std::chrono::steady_clock::now()) {
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    ~ScopedTimer() {
+        histogram_.Record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+    }
+
+private:
+    ConcurrentHistogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace metrics
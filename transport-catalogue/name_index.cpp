@@ -0,0 +1,79 @@
+#include "name_index.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace transport {
+
+namespace {
+
+char FoldCase(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+std::string FoldCase(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(), [](char c) {
+        return FoldCase(c);
+    });
+    return result;
+}
+
+} // namespace
+
+void NamePrefixIndex::Build(const std::vector<std::string_view>& stop_names, const std::vector<std::string_view>& bus_names) {
+    keys_.clear();
+    auto fill = [this](const std::vector<std::string_view>& names, NameKind kind) {
+        auto& entries = entries_[static_cast<size_t>(kind)];
+        entries.clear();
+        entries.reserve(names.size());
+        for (const auto name : names) {
+            entries.push_back({static_cast<uint32_t>(keys_.size()), static_cast<uint32_t>(name.size()), name});
+            keys_ += FoldCase(name);
+        }
+        std::sort(entries.begin(), entries.end(), [this](const Entry& lhs, const Entry& rhs) {
+            return std::tuple(GetKey(lhs), lhs.name) < std::tuple(GetKey(rhs), rhs.name);
+        });
+    };
+    fill(stop_names, NameKind::STOP);
+    fill(bus_names, NameKind::BUS);
+}
+
+std::pair<NamePrefixIndex::EntryIterator, NamePrefixIndex::EntryIterator> NamePrefixIndex::FindRange(NameKind kind, std::string_view key) const {
+    const auto& entries = GetEntries(kind);
+    const auto begin = std::lower_bound(entries.begin(), entries.end(), key, [this](const Entry& entry, std::string_view value) {
+        return GetKey(entry) < value;
+    });
+    // Ключи с префиксом key идут подряд сразу за begin
+    const auto end = std::partition_point(begin, entries.end(), [this, key](const Entry& entry) {
+        return GetKey(entry).substr(0, key.size()) == key;
+    });
+    return {begin, end};
+}
+
+std::vector<NameMatch> NamePrefixIndex::FindByPrefix(std::string_view prefix, size_t limit, std::optional<NameKind> kind) const {
+    std::vector<NameMatch> result;
+    const std::string key = FoldCase(prefix);
+    if (kind) {
+        const auto [begin, end] = FindRange(*kind, key);
+        for (auto it = begin; it != end && result.size() < limit; ++it) {
+            result.push_back({it->name, *kind});
+        }
+        return result;
+    }
+    // Слияние по (ключ, имя); при равенстве остановка идёт раньше маршрута
+    auto [stop, stops_end] = FindRange(NameKind::STOP, key);
+    auto [bus, buses_end] = FindRange(NameKind::BUS, key);
+    while (result.size() < limit && (stop != stops_end || bus != buses_end)) {
+        if (bus == buses_end || (stop != stops_end && std::tuple(GetKey(*stop), stop->name) <= std::tuple(GetKey(*bus), bus->name))) {
+            result.push_back({stop->name, NameKind::STOP});
+            ++stop;
+        } else {
+            result.push_back({bus->name, NameKind::BUS});
+            ++bus;
+        }
+    }
+    return result;
+}
+
+} // namespace transport
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "memory_usage.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace transport {
+
+enum class NameKind {
+    STOP,
+    BUS,
+};
+
+struct NameMatch {
+    std::string_view name;
+    NameKind kind;
+};
+
+// Индекс для поиска по префиксу имени: отсортированные массивы записей, отдельные для остановок
+// и маршрутов, и один буфер с ключами в нижнем регистре (ASCII), поиск — двоичный по ключам.
+// Поиск одного вида не просматривает имена другого; без вида диапазоны двух массивов сливаются.
+// Имена не копируются: записи ссылаются на строки каталога
+class NamePrefixIndex {
+public:
+    void Build(const std::vector<std::string_view>& stop_names, const std::vector<std::string_view>& bus_names);
+
+    // Не больше limit имён с заданным префиксом без учёта регистра, в алфавитном порядке
+    std::vector<NameMatch> FindByPrefix(std::string_view prefix, size_t limit, std::optional<NameKind> kind = std::nullopt) const;
+
+    size_t GetSize() const {
+        return GetEntries(NameKind::STOP).size() + GetEntries(NameKind::BUS).size();
+    }
+
+    memory::Usage GetMemoryUsage() const {
+        return memory::EstimateVectorBuffer(GetEntries(NameKind::STOP)) + memory::EstimateVectorBuffer(GetEntries(NameKind::BUS))
+            + memory::EstimateString(keys_);
+    }
+
+private:
+    struct Entry {
+        uint32_t key_offset;
+        uint32_t key_length;
+        std::string_view name;
+    };
+    using EntryIterator = std::vector<Entry>::const_iterator;
+
+    std::string_view GetKey(const Entry& entry) const {
+        return std::string_view(keys_).substr(entry.key_offset, entry.key_length);
+    }
+
+    const std::vector<Entry>& GetEntries(NameKind kind) const {
+        return entries_[static_cast<size_t>(kind)];
+    }
+
+    // Записи вида kind, ключи которых начинаются с key
+    std::pair<EntryIterator, EntryIterator> FindRange(NameKind kind, std::string_view key) const;
+
+    // Индекс — NameKind
+    std::array<std::vector<Entry>, 2> entries_;
+    std::string keys_;
+};
+
+} // namespace transport
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "graph.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+namespace graph {
+
+// Маршрут, оптимальный по Парето по двум критериям: весу и числу рёбер, отмеченных
+// функцией подсчёта (например, посадок)
+template <typename Weight, typename Id = size_t>
+struct ParetoRoute {
+    Weight weight{};
+    uint32_t count = 0;
+    std::vector<Id> edges;
+};
+
+// Многокритериальный Дейкстра с мешками меток. Метки извлекаются в лексикографическом
+// порядке (вес, счётчик), поэтому у всех уже закреплённых в вершине меток вес не больше,
+// и новая метка не доминируется мешком вершины, только если её счётчик строго меньше
+// наименьшего закреплённого. Мешок вершины сводится к этому минимуму, проверка — O(1).
+// Метки, доминируемые мешком цели, отбрасываются сразу.
+// Результат упорядочен по возрастанию веса и строгому убыванию счётчика
+template <typename Weight, typename Id, typename CountEdge>
+std::vector<ParetoRoute<Weight, Id>> FindParetoRoutes(const DirectedWeightedGraph<Weight, Id>& graph,
+                                                      typename DirectedWeightedGraph<Weight, Id>::VertexId from,
+                                                      typename DirectedWeightedGraph<Weight, Id>::VertexId to,
+                                                      CountEdge count_edge) {
+    constexpr uint32_t NO_LABEL = std::numeric_limits<uint32_t>::max();
+    constexpr Weight zero_weight{};
+    struct Label {
+        Weight weight;
+        uint32_t count;
+        Id vertex;
+        Id edge;
+        uint32_t parent;
+    };
+    std::vector<Label> labels;
+    std::vector<uint32_t> min_count(graph.GetVertexCount(), std::numeric_limits<uint32_t>::max());
+    using QueueItem = std::tuple<Weight, uint32_t, uint32_t>;
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+    labels.push_back({zero_weight, 0, from, Id{}, NO_LABEL});
+    queue.emplace(zero_weight, 0, 0);
+    std::vector<uint32_t> target_labels;
+    while (!queue.empty()) {
+        const auto [weight, count, label_index] = queue.top();
+        queue.pop();
+        const Id vertex = labels[label_index].vertex;
+        if (count >= min_count[vertex] || count >= min_count[to]) {
+            continue;
+        }
+        min_count[vertex] = count;
+        if (vertex == to) {
+            target_labels.push_back(label_index);
+            continue;
+        }
+        for (const Id edge_id : graph.GetIncidentEdges(vertex)) {
+            const auto& edge = graph.GetEdge(edge_id);
+            if (edge.weight < zero_weight) {
+                throw std::domain_error("Edges' weights should be non-negative");
+            }
+            const uint32_t next_count = count + (count_edge(edge_id) ? 1 : 0);
+            if (next_count >= min_count[edge.to] || next_count >= min_count[to]) {
+                continue;
+            }
+            labels.push_back({weight + edge.weight, next_count, edge.to, edge_id, label_index});
+            queue.emplace(weight + edge.weight, next_count, static_cast<uint32_t>(labels.size() - 1));
+        }
+    }
+
+    std::vector<ParetoRoute<Weight, Id>> result;
+    for (const uint32_t label_index : target_labels) {
+        ParetoRoute<Weight, Id> route{labels[label_index].weight, labels[label_index].count, {}};
+        for (uint32_t i = label_index; labels[i].parent != NO_LABEL; i = labels[i].parent) {
+            route.edges.push_back(labels[i].edge);
+        }
+        std::reverse(route.edges.begin(), route.edges.end());
+        result.push_back(std::move(route));
+    }
+    return result;
+}
+
+}  // namespace graph
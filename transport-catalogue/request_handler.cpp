@@ -1,11 +1,8 @@
 #include "request_handler.h"
+#include "metrics.h"
 
-std::optional<transport::BusInfo> RequestHandler::GetBusStat(const std::string_view bus_number) const {
+transport::BusInfo RequestHandler::GetBusStat(const transport::Bus* bus) const {
     transport::BusInfo bus_stat{};
-    const transport::Bus* bus = catalogue_.FindBus(bus_number);
-    if (!bus) {
-		throw std::out_of_range("The bus is not in the catalog");
-	}
     if (bus->is_roundtrip) {
         bus_stat.stops_count = bus->stops.size();
     }
@@ -13,20 +10,27 @@ std::optional<transport::BusInfo> RequestHandler::GetBusStat(const std::string_v
         bus_stat.stops_count = bus->stops.size() * 2 - 1;
     }
     int route_length = 0;
-    double geographic_length = 0.0;
-    for (size_t i = 0; i < bus->stops.size() - 1; ++i) {
+    std::vector<uint32_t> path;
+    path.reserve(bus->stops.size());
+    for (size_t i = 0; i < bus->stops.size(); ++i) {
+        path.push_back(bus->stops[i]->id);
+        if (i + 1 == bus->stops.size()) {
+            break;
+        }
         auto from = bus->stops[i];
         auto to = bus->stops[i + 1];
         if (bus->is_roundtrip) {
             route_length += catalogue_.GetStopDistance(from, to);
-            geographic_length += geo::ComputeDistance(from->coordinates, to->coordinates);
         }
         else {
             route_length += catalogue_.GetStopDistance(from, to) + catalogue_.GetStopDistance(to, from);
-            geographic_length += geo::ComputeDistance(from->coordinates, to->coordinates) * 2;
         }
     }
-    bus_stat.unique_stops_count = catalogue_.GetNumberOfUniqueStops(bus_number);
+    double geographic_length = geo::ComputePathLength(catalogue_.GetStopVectors(), path);
+    if (!bus->is_roundtrip) {
+        geographic_length *= 2;
+    }
+    bus_stat.unique_stops_count = catalogue_.GetNumberOfUniqueStops(bus);
     bus_stat.route_length = route_length;
     bus_stat.curvature = route_length / geographic_length;
 
@@ -37,22 +41,95 @@ svg::Document RequestHandler::RenderMap() const {
     return renderer_.RenderMap(catalogue_.GetSortedBuses());
 }
 
-const std::set<std::string> RequestHandler::GetBusesOnStop(std::string_view stop_name) const {
-    return catalogue_.FindStop(stop_name)->buses;
+svg::Document RequestHandler::RenderIsochrone(const std::vector<std::pair<const transport::Stop*, double>>& reachable_stops, double max_time) const {
+    return renderer_.RenderIsochrone(catalogue_.GetSortedBuses(), reachable_stops, max_time);
+}
+
+const transport::Stop* RequestHandler::FindStop(std::string_view stop_name) const {
+    return catalogue_.FindStop(stop_name);
 }
 
-bool RequestHandler::SearchBusNumber(const std::string_view bus_number) const {
+const transport::Bus* RequestHandler::FindBus(std::string_view bus_number) const {
     return catalogue_.FindBus(bus_number);
 }
 
-bool RequestHandler::SearchStopName(const std::string_view stop_name) const {
-    return catalogue_.FindStop(stop_name);
+const transport::Stop* RequestHandler::FindStop(uint32_t stop_id) const {
+    return catalogue_.FindStop(stop_id);
+}
+
+const transport::Bus* RequestHandler::FindBus(uint32_t bus_id) const {
+    return catalogue_.FindBus(bus_id);
 }
 
-const std::optional<graph::Router<double>::RouteInfo> RequestHandler::GetRouting(const std::string_view stop_name_from, const std::string_view stop_name_to) const {
-    return router_.FindRoute(stop_name_from, stop_name_to);
+transport::Catalogue::BusesRange RequestHandler::GetBusesOnStop(const transport::Stop* stop) const {
+    return catalogue_.GetBusesOnStop(stop);
 }
 
-const graph::DirectedWeightedGraph<double>& RequestHandler::GetRouterGraph() const {
+const std::optional<transport::TransportRouter::RouteInfo> RequestHandler::GetRouting(const transport::Stop* stop_from, const transport::Stop* stop_to) const {
+    return router_.FindRoute(stop_from, stop_to);
+}
+
+std::vector<graph::ParetoRoute<transport::RouteWeight, transport::RouteId>> RequestHandler::GetParetoRoutings(const transport::Stop* stop_from, const transport::Stop* stop_to) const {
+    return router_.FindParetoRoutes(stop_from, stop_to);
+}
+
+const transport::RouteGraph& RequestHandler::GetRouterGraph() const {
     return router_.GetGraph();
 }
+
+std::vector<std::pair<const transport::Stop*, double>> RequestHandler::GetReachableStops(const transport::Stop* stop_from, double max_time) const {
+    return router_.FindReachableStops(stop_from, max_time);
+}
+
+std::vector<std::pair<const transport::Stop*, double>> RequestHandler::FindNearestStops(geo::Coordinates center, std::optional<size_t> count, std::optional<double> max_distance) const {
+    return catalogue_.GetSpatialIndex().FindNearest(center, count, max_distance);
+}
+
+std::vector<const transport::Stop*> RequestHandler::FindStopsInArea(geo::Coordinates min, geo::Coordinates max) const {
+    return catalogue_.GetSpatialIndex().FindInArea(min, max);
+}
+
+std::vector<transport::NameMatch> RequestHandler::FindNamesByPrefix(std::string_view prefix, size_t limit, std::optional<transport::NameKind> kind) const {
+    return catalogue_.GetNameIndex().FindByPrefix(prefix, limit, kind);
+}
+
+std::optional<transport::TimetableRouter::Journey> RequestHandler::FindEarliestArrival(const transport::Stop* stop_from, const transport::Stop* stop_to, double departure_time) const {
+    return router_.GetTimetable().FindEarliestArrival(stop_from, stop_to, departure_time);
+}
+
+std::vector<transport::TransportRouter::TravelTimes> RequestHandler::GetTravelTimes(const std::vector<const transport::Stop*>& stops_from, const std::vector<const transport::Stop*>& stops_to) const {
+    return router_.FindTravelTimes(stops_from, stops_to);
+}
+
+std::pair<transport::RouteId, transport::RouteId> RequestHandler::GetRouteKey(const transport::Stop* stop_from, const transport::Stop* stop_to) const {
+    return {router_.GetStopId(stop_from), router_.GetStopId(stop_to)};
+}
+
+std::shared_ptr<const CachedRoute> RequestHandler::FindCachedRouting(const transport::Stop* stop_from, const transport::Stop* stop_to) const {
+    return route_cache_.Get(GetRouteKey(stop_from, stop_to));
+}
+
+std::shared_ptr<const CachedRoute> RequestHandler::CacheRouting(const transport::Stop* stop_from, const transport::Stop* stop_to, CachedRoute route) const {
+    return route_cache_.Put(GetRouteKey(stop_from, stop_to), std::move(route));
+}
+
+RouteCache::Stats RequestHandler::GetRouteCacheStats() const {
+    return route_cache_.GetStats();
+}
+
+void RequestHandler::UpdateMetrics() const {
+    auto& registry = metrics::Registry::Instance();
+    registry.GetGauge("tc_catalogue_stops").Set(catalogue_.GetStopCount());
+    registry.GetGauge("tc_catalogue_buses").Set(catalogue_.GetBusCount());
+    registry.GetGauge("tc_catalogue_stop_distances").Set(catalogue_.GetStopDistanceCount());
+    registry.GetGauge("tc_router_graph_vertices").Set(router_.GetGraph().GetVertexCount());
+    registry.GetGauge("tc_router_graph_edges").Set(router_.GetGraph().GetEdgeCount());
+    const auto search_stats = router_.GetSearchStats();
+    registry.GetGauge("tc_router_searches").Set(search_stats.searches);
+    registry.GetGauge("tc_router_settled_vertices").Set(search_stats.settled_vertices);
+    const auto cache_stats = route_cache_.GetStats();
+    registry.GetGauge("tc_route_cache_hits").Set(cache_stats.hits);
+    registry.GetGauge("tc_route_cache_misses").Set(cache_stats.misses);
+    registry.GetGauge("tc_route_cache_evictions").Set(cache_stats.evictions);
+    registry.GetGauge("tc_route_cache_size").Set(cache_stats.size);
+}
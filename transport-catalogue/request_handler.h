@@ -1,31 +1,77 @@
 #pragma once
 
 #include "json.h"
+#include "lru_cache.h"
 #include "map_renderer.h"
 #include "transport_catalogue.h"
 #include "transport_router.h"
+#include "transport_snapshot.h"
 
 #include <sstream>
 
+struct CachedRoute {
+    double total_time = 0.0;
+    json::Array items;
+};
+
+struct RouteKeyHasher {
+    size_t operator()(const std::pair<transport::RouteId, transport::RouteId>& key) const {
+        return std::hash<transport::RouteId>{}(key.first) * 37 + std::hash<transport::RouteId>{}(key.second);
+    }
+};
+
+using RouteCache = cache::LruCache<std::pair<transport::RouteId, transport::RouteId>, CachedRoute, RouteKeyHasher>;
+
+inline constexpr size_t DEFAULT_ROUTE_CACHE_CAPACITY = 4096;
+
 class RequestHandler {
 public:
-    RequestHandler(const transport::Catalogue& catalogue, const renderer::MapRenderer& renderer, const transport::TransportRouter& router)
+    RequestHandler(const transport::Catalogue& catalogue, const renderer::MapRenderer& renderer, const transport::TransportRouter& router,
+                   size_t route_cache_capacity = DEFAULT_ROUTE_CACHE_CAPACITY)
         : catalogue_(catalogue)
         , renderer_(renderer)
         , router_(router)
+        , route_cache_(route_cache_capacity)
+    {
+    }
+
+    // Снимок должен жить не меньше обработчика
+    RequestHandler(const transport::Snapshot& snapshot, const renderer::MapRenderer& renderer,
+                   size_t route_cache_capacity = DEFAULT_ROUTE_CACHE_CAPACITY)
+        : RequestHandler(*snapshot.catalogue, renderer, *snapshot.router, route_cache_capacity)
     {
     }
 
     svg::Document RenderMap() const;
-    std::optional<transport::BusInfo> GetBusStat(const std::string_view bus_number) const;
-    const std::set<std::string> GetBusesOnStop(std::string_view stop_name) const;
-    bool SearchBusNumber(const std::string_view bus_number) const;
-    bool SearchStopName(const std::string_view stop_name) const;
-    const std::optional<graph::Router<double>::RouteInfo> GetRouting(const std::string_view stop_name_from, const std::string_view stop_name_to) const;
-    const graph::DirectedWeightedGraph<double>& GetRouterGraph() const;
+    svg::Document RenderIsochrone(const std::vector<std::pair<const transport::Stop*, double>>& reachable_stops, double max_time) const;
+    // nullptr, если остановки или маршрута нет в каталоге
+    const transport::Stop* FindStop(std::string_view stop_name) const;
+    const transport::Bus* FindBus(std::string_view bus_number) const;
+    const transport::Stop* FindStop(uint32_t stop_id) const;
+    const transport::Bus* FindBus(uint32_t bus_id) const;
+    // Остальные методы принимают объекты каталога, найденные FindStop и FindBus
+    transport::BusInfo GetBusStat(const transport::Bus* bus) const;
+    transport::Catalogue::BusesRange GetBusesOnStop(const transport::Stop* stop) const;
+    const std::optional<transport::TransportRouter::RouteInfo> GetRouting(const transport::Stop* stop_from, const transport::Stop* stop_to) const;
+    std::vector<graph::ParetoRoute<transport::RouteWeight, transport::RouteId>> GetParetoRoutings(const transport::Stop* stop_from, const transport::Stop* stop_to) const;
+    const transport::RouteGraph& GetRouterGraph() const;
+    std::vector<std::pair<const transport::Stop*, double>> GetReachableStops(const transport::Stop* stop_from, double max_time) const;
+    std::vector<std::pair<const transport::Stop*, double>> FindNearestStops(geo::Coordinates center, std::optional<size_t> count, std::optional<double> max_distance) const;
+    std::vector<const transport::Stop*> FindStopsInArea(geo::Coordinates min, geo::Coordinates max) const;
+    std::vector<transport::NameMatch> FindNamesByPrefix(std::string_view prefix, size_t limit, std::optional<transport::NameKind> kind) const;
+    std::vector<transport::TransportRouter::TravelTimes> GetTravelTimes(const std::vector<const transport::Stop*>& stops_from, const std::vector<const transport::Stop*>& stops_to) const;
+    std::optional<transport::TimetableRouter::Journey> FindEarliestArrival(const transport::Stop* stop_from, const transport::Stop* stop_to, double departure_time) const;
+    std::shared_ptr<const CachedRoute> FindCachedRouting(const transport::Stop* stop_from, const transport::Stop* stop_to) const;
+    std::shared_ptr<const CachedRoute> CacheRouting(const transport::Stop* stop_from, const transport::Stop* stop_to, CachedRoute route) const;
+    RouteCache::Stats GetRouteCacheStats() const;
+    // Переносит размеры каталога, статистику поиска и кэша маршрутов в реестр метрик
+    void UpdateMetrics() const;
 
 private:
     const transport::Catalogue& catalogue_;
     const renderer::MapRenderer& renderer_;
     const transport::TransportRouter& router_;
+    mutable RouteCache route_cache_;
+
+    std::pair<transport::RouteId, transport::RouteId> GetRouteKey(const transport::Stop* stop_from, const transport::Stop* stop_to) const;
 };
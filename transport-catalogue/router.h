@@ -1,11 +1,14 @@
 #pragma once
 
+#include "all_pairs.h"
 #include "graph.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <iterator>
+#include <functional>
 #include <optional>
 #include <stdexcept>
 #include <unordered_map>
@@ -14,27 +17,170 @@
 
 namespace graph {
 
-template <typename Weight>
+// ALL_PAIRS заранее считает маршруты между всеми парами вершин (O(V^3) времени, O(V^2) памяти),
+// ON_DEMAND ничего не предрассчитывает и запускает алгоритм Дейкстры на каждый запрос.
+// ALL_PAIRS_BLOCKED даёт те же веса маршрутов, что и ALL_PAIRS, но считает их блочным
+// Флойдом–Уоршеллом по плоским матрицам в несколько потоков (см. all_pairs.h)
+enum class RoutingMode {
+    ALL_PAIRS,
+    ON_DEMAND,
+    ALL_PAIRS_BLOCKED,
+};
+
+template <typename Weight, typename Id = size_t>
 class Router {
 private:
-    using Graph = DirectedWeightedGraph<Weight>;
+    using Graph = DirectedWeightedGraph<Weight, Id>;
 
 public:
-    explicit Router(const Graph& graph);
+    using VertexId = Id;
+    using EdgeId = Id;
+
+    explicit Router(const Graph& graph, RoutingMode mode = RoutingMode::ALL_PAIRS);
 
     struct RouteInfo {
         Weight weight;
         std::vector<EdgeId> edges;
     };
 
+    struct SearchStats {
+        uint64_t searches = 0;
+        uint64_t settled_vertices = 0;
+    };
+
     std::optional<RouteInfo> BuildRoute(VertexId from, VertexId to) const;
+    std::optional<Weight> GetRouteWeight(VertexId from, VertexId to) const;
+    std::vector<std::optional<Weight>> GetRouteWeights(VertexId from, const std::vector<VertexId>& targets) const;
+    std::vector<std::pair<VertexId, Weight>> GetReachableVertices(VertexId from, Weight max_weight) const;
+    SearchStats GetSearchStats() const;
+    // Таблица маршрутов всех пар; в режиме ON_DEMAND она пуста
+    memory::Usage GetMemoryUsage() const;
 
 private:
     struct RouteInternalData {
         Weight weight;
         std::optional<EdgeId> prev_edge;
     };
-    using RoutesInternalData = std::vector<std::vector<std::optional<RouteInternalData>>>;
+    using RoutesInternalRow = std::vector<std::optional<RouteInternalData>>;
+    using RoutesInternalData = std::vector<RoutesInternalRow>;
+    using QueueItem = std::pair<Weight, VertexId>;
+
+    // Рабочие массивы поиска в режиме ON_DEMAND, свои у каждого потока. Между запросами в routes
+    // и settled заполнены только вершины из touched, и следующий запрос сбрасывает лишь их
+    struct SearchScratch {
+        RoutesInternalRow routes;
+        std::vector<bool> settled;
+        std::vector<VertexId> touched;
+        std::vector<QueueItem> queue;
+
+        void Prepare(size_t vertex_count) {
+            for (const VertexId vertex : touched) {
+                routes[vertex].reset();
+                settled[vertex] = false;
+            }
+            touched.clear();
+            queue.clear();
+            if (routes.size() < vertex_count) {
+                routes.resize(vertex_count);
+                settled.resize(vertex_count, false);
+            }
+        }
+    };
+
+    const RoutesInternalRow& GetRoutesFrom(VertexId from, RoutesInternalRow& storage,
+                                           std::optional<VertexId> target = std::nullopt,
+                                           std::optional<Weight> max_weight = std::nullopt) const {
+        if (mode_ == RoutingMode::ALL_PAIRS) {
+            return routes_internal_data_.at(from);
+        }
+        if (mode_ == RoutingMode::ALL_PAIRS_BLOCKED) {
+            storage.assign(blocked_routes_.vertex_count, std::nullopt);
+            for (VertexId to = 0; to < blocked_routes_.vertex_count; ++to) {
+                storage[to] = GetBlockedRoute(from, to);
+            }
+            return storage;
+        }
+        return ComputeRoutesFrom(from, target, max_weight);
+    }
+
+    std::optional<RouteInternalData> GetBlockedRoute(VertexId from, VertexId to) const {
+        const size_t index = from * blocked_routes_.vertex_count + to;
+        const Weight weight = blocked_routes_.weights.at(index);
+        if (!(weight < all_pairs::GetUnreachableWeight<Weight>())) {
+            return std::nullopt;
+        }
+        const EdgeId last_edge = blocked_routes_.last_edges[index];
+        return RouteInternalData{weight, last_edge == all_pairs::NO_EDGE<Id> ? std::nullopt : std::optional<EdgeId>(last_edge)};
+    }
+
+    std::optional<RouteInfo> BuildBlockedRoute(VertexId from, VertexId to) const {
+        const auto route = GetBlockedRoute(from, to);
+        if (!route) {
+            return std::nullopt;
+        }
+        std::vector<EdgeId> edges;
+        for (std::optional<EdgeId> edge_id = route->prev_edge;
+             edge_id;
+             edge_id = GetBlockedRoute(from, graph_.GetEdge(*edge_id).from)->prev_edge)
+        {
+            edges.push_back(*edge_id);
+        }
+        std::reverse(edges.begin(), edges.end());
+        return RouteInfo{route->weight, std::move(edges)};
+    }
+
+    // Строка лежит в рабочих массивах потока и действительна до следующего поиска в нём;
+    // она может быть длиннее числа вершин графа
+    const RoutesInternalRow& ComputeRoutesFrom(VertexId from, std::optional<VertexId> target,
+                                               std::optional<Weight> max_weight) const {
+        thread_local SearchScratch scratch;
+        scratch.Prepare(graph_.GetVertexCount());
+        auto& routes = scratch.routes;
+        auto& settled = scratch.settled;
+        auto& queue = scratch.queue;
+        const auto push = [&](Weight weight, VertexId vertex) {
+            queue.emplace_back(weight, vertex);
+            std::push_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+        };
+        uint64_t settled_count = 0;
+        routes.at(from) = RouteInternalData{ZERO_WEIGHT, std::nullopt};
+        scratch.touched.push_back(from);
+        push(ZERO_WEIGHT, from);
+        while (!queue.empty()) {
+            std::pop_heap(queue.begin(), queue.end(), std::greater<QueueItem>{});
+            const auto [weight, vertex] = queue.back();
+            queue.pop_back();
+            if (settled[vertex]) {
+                continue;
+            }
+            settled[vertex] = true;
+            ++settled_count;
+            if (vertex == target) {
+                break;
+            }
+            for (const EdgeId edge_id : graph_.GetIncidentEdges(vertex)) {
+                const auto& edge = graph_.GetEdge(edge_id);
+                if (edge.weight < ZERO_WEIGHT) {
+                    throw std::domain_error("Edges' weights should be non-negative");
+                }
+                const Weight candidate_weight = weight + edge.weight;
+                if (max_weight && *max_weight < candidate_weight) {
+                    continue;
+                }
+                auto& route = routes[edge.to];
+                if (!route) {
+                    scratch.touched.push_back(edge.to);
+                }
+                if (!route || candidate_weight < route->weight) {
+                    route = RouteInternalData{candidate_weight, edge_id};
+                    push(candidate_weight, edge.to);
+                }
+            }
+        }
+        searches_.fetch_add(1, std::memory_order_relaxed);
+        settled_vertices_.fetch_add(settled_count, std::memory_order_relaxed);
+        return routes;
+    }
 
     void InitializeRoutesInternalData(const Graph& graph) {
         const size_t vertex_count = graph.GetVertexCount();
@@ -77,15 +223,26 @@ private:
 
     static constexpr Weight ZERO_WEIGHT{};
     const Graph& graph_;
+    RoutingMode mode_;
     RoutesInternalData routes_internal_data_;
+    all_pairs::Matrix<Weight, Id> blocked_routes_;
+    mutable std::atomic<uint64_t> searches_ = 0;
+    mutable std::atomic<uint64_t> settled_vertices_ = 0;
 };
 
-template <typename Weight>
-Router<Weight>::Router(const Graph& graph)
+template <typename Weight, typename Id>
+Router<Weight, Id>::Router(const Graph& graph, RoutingMode mode)
     : graph_(graph)
-    , routes_internal_data_(graph.GetVertexCount(),
-                            std::vector<std::optional<RouteInternalData>>(graph.GetVertexCount()))
+    , mode_(mode)
 {
+    if (mode_ == RoutingMode::ON_DEMAND) {
+        return;
+    }
+    if (mode_ == RoutingMode::ALL_PAIRS_BLOCKED) {
+        blocked_routes_ = all_pairs::ComputeBlocked(graph);
+        return;
+    }
+    routes_internal_data_.assign(graph.GetVertexCount(), RoutesInternalRow(graph.GetVertexCount()));
     InitializeRoutesInternalData(graph);
 
     const size_t vertex_count = graph.GetVertexCount();
@@ -94,10 +251,15 @@ Router<Weight>::Router(const Graph& graph)
     }
 }
 
-template <typename Weight>
-std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(VertexId from,
-                                                                             VertexId to) const {
-    const auto& route_internal_data = routes_internal_data_.at(from).at(to);
+template <typename Weight, typename Id>
+std::optional<typename Router<Weight, Id>::RouteInfo> Router<Weight, Id>::BuildRoute(VertexId from,
+                                                                                     VertexId to) const {
+    if (mode_ == RoutingMode::ALL_PAIRS_BLOCKED) {
+        return BuildBlockedRoute(from, to);
+    }
+    RoutesInternalRow storage;
+    const auto& routes_from = GetRoutesFrom(from, storage, to);
+    const auto& route_internal_data = routes_from.at(to);
     if (!route_internal_data) {
         return std::nullopt;
     }
@@ -105,7 +267,7 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     std::vector<EdgeId> edges;
     for (std::optional<EdgeId> edge_id = route_internal_data->prev_edge;
          edge_id;
-         edge_id = routes_internal_data_[from][graph_.GetEdge(*edge_id).from]->prev_edge)
+         edge_id = routes_from[graph_.GetEdge(*edge_id).from]->prev_edge)
     {
         edges.push_back(*edge_id);
     }
@@ -114,4 +276,66 @@ std::optional<typename Router<Weight>::RouteInfo> Router<Weight>::BuildRoute(Ver
     return RouteInfo{weight, std::move(edges)};
 }
 
+template <typename Weight, typename Id>
+std::optional<Weight> Router<Weight, Id>::GetRouteWeight(VertexId from, VertexId to) const {
+    if (mode_ == RoutingMode::ALL_PAIRS_BLOCKED) {
+        if (const auto route = GetBlockedRoute(from, to)) {
+            return route->weight;
+        }
+        return std::nullopt;
+    }
+    RoutesInternalRow storage;
+    if (const auto& route_internal_data = GetRoutesFrom(from, storage, to).at(to)) {
+        return route_internal_data->weight;
+    }
+    return std::nullopt;
+}
+
+template <typename Weight, typename Id>
+std::vector<std::optional<Weight>> Router<Weight, Id>::GetRouteWeights(VertexId from,
+                                                                       const std::vector<VertexId>& targets) const {
+    RoutesInternalRow storage;
+    const auto& routes_from = GetRoutesFrom(from, storage);
+    std::vector<std::optional<Weight>> result;
+    result.reserve(targets.size());
+    for (const VertexId to : targets) {
+        if (const auto& route_internal_data = routes_from.at(to)) {
+            result.push_back(route_internal_data->weight);
+        } else {
+            result.push_back(std::nullopt);
+        }
+    }
+    return result;
+}
+
+template <typename Weight, typename Id>
+std::vector<std::pair<Id, Weight>> Router<Weight, Id>::GetReachableVertices(VertexId from,
+                                                                           Weight max_weight) const {
+    RoutesInternalRow storage;
+    const auto& routes_from = GetRoutesFrom(from, storage, std::nullopt, max_weight);
+    std::vector<std::pair<VertexId, Weight>> result;
+    for (VertexId to = 0; to < graph_.GetVertexCount(); ++to) {
+        if (routes_from[to] && !(max_weight < routes_from[to]->weight)) {
+            result.emplace_back(to, routes_from[to]->weight);
+        }
+    }
+    return result;
+}
+
+template <typename Weight, typename Id>
+typename Router<Weight, Id>::SearchStats Router<Weight, Id>::GetSearchStats() const {
+    return {searches_.load(std::memory_order_relaxed), settled_vertices_.load(std::memory_order_relaxed)};
+}
+
+template <typename Weight, typename Id>
+memory::Usage Router<Weight, Id>::GetMemoryUsage() const {
+    memory::Usage result = memory::EstimateVectorBuffer(routes_internal_data_);
+    for (const auto& row : routes_internal_data_) {
+        result += memory::EstimateVectorBuffer(row);
+    }
+    result += memory::EstimateVectorBuffer(blocked_routes_.weights);
+    result += memory::EstimateVectorBuffer(blocked_routes_.last_edges);
+    return result;
+}
+
 }  // namespace graph
@@ -0,0 +1,200 @@
+#include "spatial_index.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace transport {
+
+namespace {
+
+double GetAxis(const geo::UnitVector& vector, int axis) {
+    return axis == 0 ? vector.x : axis == 1 ? vector.y : vector.z;
+}
+
+double GetSquaredDistance(const geo::UnitVector& lhs, const geo::UnitVector& rhs) {
+    const double dx = lhs.x - rhs.x;
+    const double dy = lhs.y - rhs.y;
+    const double dz = lhs.z - rhs.z;
+    return dx * dx + dy * dy + dz * dz;
+}
+
+// Квадрат расстояния от точки до ближайшей точки параллелепипеда
+double GetSquaredDistanceToBox(const geo::UnitVector& point, const geo::UnitVector& box_min, const geo::UnitVector& box_max) {
+    double result = 0;
+    for (int axis = 0; axis < 3; ++axis) {
+        const double value = GetAxis(point, axis);
+        const double delta = std::max({GetAxis(box_min, axis) - value, 0.0, value - GetAxis(box_max, axis)});
+        result += delta * delta;
+    }
+    return result;
+}
+
+bool IsInside(geo::Coordinates point, geo::Coordinates min, geo::Coordinates max) {
+    return point.lat >= min.lat && point.lat <= max.lat && point.lng >= min.lng && point.lng <= max.lng;
+}
+
+} // namespace
+
+bool StopSpatialIndex::IsCloser(const Candidate& lhs, const Candidate& rhs) {
+    return std::pair(lhs.chord_squared, std::string_view(lhs.stop->name)) < std::pair(rhs.chord_squared, std::string_view(rhs.stop->name));
+}
+
+void StopSpatialIndex::Build(const std::vector<const Stop*>& stops) {
+    points_.clear();
+    nodes_.clear();
+    points_.reserve(stops.size());
+    for (const Stop* stop : stops) {
+        points_.push_back({geo::ToUnitVector(stop->coordinates), stop->coordinates, stop});
+    }
+    if (!points_.empty()) {
+        nodes_.reserve(2 * (points_.size() / LEAF_SIZE + 1));
+        BuildNode(0, static_cast<uint32_t>(points_.size()));
+    }
+}
+
+uint32_t StopSpatialIndex::BuildNode(uint32_t begin, uint32_t end) {
+    const auto node_index = static_cast<uint32_t>(nodes_.size());
+    Node node;
+    node.begin = begin;
+    node.end = end;
+    node.box_min = node.box_max = points_[begin].vector;
+    node.area_min = node.area_max = points_[begin].coordinates;
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        const auto& [vector, coordinates, stop] = points_[i];
+        node.box_min = {std::min(node.box_min.x, vector.x), std::min(node.box_min.y, vector.y), std::min(node.box_min.z, vector.z)};
+        node.box_max = {std::max(node.box_max.x, vector.x), std::max(node.box_max.y, vector.y), std::max(node.box_max.z, vector.z)};
+        node.area_min = {std::min(node.area_min.lat, coordinates.lat), std::min(node.area_min.lng, coordinates.lng)};
+        node.area_max = {std::max(node.area_max.lat, coordinates.lat), std::max(node.area_max.lng, coordinates.lng)};
+    }
+    nodes_.push_back(node);
+    if (end - begin <= LEAF_SIZE) {
+        return node_index;
+    }
+
+    int split_axis = 0;
+    for (int axis = 1; axis < 3; ++axis) {
+        if (GetAxis(node.box_max, axis) - GetAxis(node.box_min, axis) > GetAxis(node.box_max, split_axis) - GetAxis(node.box_min, split_axis)) {
+            split_axis = axis;
+        }
+    }
+    const uint32_t middle = begin + (end - begin) / 2;
+    std::nth_element(points_.begin() + begin, points_.begin() + middle, points_.begin() + end, [split_axis](const Point& lhs, const Point& rhs) {
+        return GetAxis(lhs.vector, split_axis) < GetAxis(rhs.vector, split_axis);
+    });
+    BuildNode(begin, middle);
+    const uint32_t right = BuildNode(middle, end);
+    nodes_[node_index].right = right;
+    return node_index;
+}
+
+std::vector<std::pair<const Stop*, double>> StopSpatialIndex::FindNearest(geo::Coordinates center, std::optional<size_t> count,
+                                                                          std::optional<double> max_distance) const {
+    std::vector<std::pair<const Stop*, double>> result;
+    if (nodes_.empty() || (count && *count == 0)) {
+        return result;
+    }
+    const geo::UnitVector center_vector = geo::ToUnitVector(center);
+    double bound = std::numeric_limits<double>::infinity();
+    if (max_distance) {
+        const double chord = geo::DistanceToChord(std::max(*max_distance, 0.0));
+        // Небольшой запас, чтобы граничные точки не терялись из-за округления
+        bound = chord * chord * (1.0 + 1e-12);
+    }
+    std::vector<Candidate> heap;
+    SearchNearest(0, center_vector, count.value_or(points_.size()), bound, heap);
+    std::sort(heap.begin(), heap.end(), IsCloser);
+    result.reserve(heap.size());
+    for (const auto& [chord_squared, stop] : heap) {
+        const double distance = geo::ChordToDistance(std::sqrt(chord_squared));
+        if (max_distance && distance > *max_distance) {
+            continue;
+        }
+        result.emplace_back(stop, distance);
+    }
+    return result;
+}
+
+// heap — max-куча из не более count лучших кандидатов; bound — текущий радиус поиска
+void StopSpatialIndex::SearchNearest(uint32_t node_index, const geo::UnitVector& center, size_t count, double& bound,
+                                     std::vector<Candidate>& heap) const {
+    const Node& node = nodes_[node_index];
+    if (GetSquaredDistanceToBox(center, node.box_min, node.box_max) > bound) {
+        return;
+    }
+    if (node.right == 0) {
+        for (uint32_t i = node.begin; i < node.end; ++i) {
+            const Candidate candidate{GetSquaredDistance(center, points_[i].vector), points_[i].stop};
+            if (candidate.chord_squared > bound) {
+                continue;
+            }
+            if (heap.size() == count) {
+                if (!IsCloser(candidate, heap.front())) {
+                    continue;
+                }
+                std::pop_heap(heap.begin(), heap.end(), IsCloser);
+                heap.back() = candidate;
+            } else {
+                heap.push_back(candidate);
+            }
+            std::push_heap(heap.begin(), heap.end(), IsCloser);
+            if (heap.size() == count) {
+                bound = std::min(bound, heap.front().chord_squared);
+            }
+        }
+        return;
+    }
+    const uint32_t left = node_index + 1;
+    const uint32_t right = node.right;
+    const double left_distance = GetSquaredDistanceToBox(center, nodes_[left].box_min, nodes_[left].box_max);
+    const double right_distance = GetSquaredDistanceToBox(center, nodes_[right].box_min, nodes_[right].box_max);
+    if (left_distance <= right_distance) {
+        SearchNearest(left, center, count, bound, heap);
+        SearchNearest(right, center, count, bound, heap);
+    } else {
+        SearchNearest(right, center, count, bound, heap);
+        SearchNearest(left, center, count, bound, heap);
+    }
+}
+
+std::vector<const Stop*> StopSpatialIndex::FindInArea(geo::Coordinates min, geo::Coordinates max) const {
+    std::vector<const Stop*> result;
+    if (nodes_.empty() || min.lat > max.lat) {
+        return result;
+    }
+    if (min.lng <= max.lng) {
+        SearchArea(0, min, max, result);
+    } else {
+        SearchArea(0, min, {max.lat, 180.0}, result);
+        SearchArea(0, {min.lat, -180.0}, max, result);
+    }
+    std::sort(result.begin(), result.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    return result;
+}
+
+void StopSpatialIndex::SearchArea(uint32_t node_index, geo::Coordinates min, geo::Coordinates max, std::vector<const Stop*>& result) const {
+    const Node& node = nodes_[node_index];
+    if (node.area_max.lat < min.lat || node.area_min.lat > max.lat || node.area_max.lng < min.lng || node.area_min.lng > max.lng) {
+        return;
+    }
+    if (IsInside(node.area_min, min, max) && IsInside(node.area_max, min, max)) {
+        for (uint32_t i = node.begin; i < node.end; ++i) {
+            result.push_back(points_[i].stop);
+        }
+        return;
+    }
+    if (node.right == 0) {
+        for (uint32_t i = node.begin; i < node.end; ++i) {
+            if (IsInside(points_[i].coordinates, min, max)) {
+                result.push_back(points_[i].stop);
+            }
+        }
+        return;
+    }
+    SearchArea(node_index + 1, min, max, result);
+    SearchArea(node.right, min, max, result);
+}
+
+} // namespace transport
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "domain.h"
+#include "geo_batch.h"
+#include "memory_usage.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace transport {
+
+// Статическое k-d дерево по остановкам. Точки хранятся единичными векторами, поэтому ближайшие
+// по хорде остановки — ближайшие и по дуге, без искажений у полюсов и на 180-м меридиане.
+// В каждом узле кроме трёхмерного ограничивающего параллелепипеда хранятся границы по широте
+// и долготе для запросов по прямоугольнику
+class StopSpatialIndex {
+public:
+    void Build(const std::vector<const Stop*>& stops);
+
+    size_t GetSize() const {
+        return points_.size();
+    }
+
+    memory::Usage GetMemoryUsage() const {
+        return memory::EstimateVectorBuffer(points_) + memory::EstimateVectorBuffer(nodes_);
+    }
+
+    // Не больше count ближайших остановок (и не дальше max_distance метров, если задано),
+    // по возрастанию расстояния; при равенстве — по имени
+    std::vector<std::pair<const Stop*, double>> FindNearest(geo::Coordinates center, std::optional<size_t> count,
+                                                            std::optional<double> max_distance) const;
+
+    // Остановки в прямоугольнике по широте и долготе, границы включаются.
+    // При min_lng > max_lng прямоугольник пересекает 180-й меридиан. Результат упорядочен по имени
+    std::vector<const Stop*> FindInArea(geo::Coordinates min, geo::Coordinates max) const;
+
+private:
+    static constexpr uint32_t LEAF_SIZE = 16;
+
+    struct Point {
+        geo::UnitVector vector;
+        geo::Coordinates coordinates;
+        const Stop* stop;
+    };
+
+    struct Node {
+        geo::UnitVector box_min;
+        geo::UnitVector box_max;
+        geo::Coordinates area_min;
+        geo::Coordinates area_max;
+        uint32_t begin = 0;
+        uint32_t end = 0;
+        // Левый потомок идёт сразу за узлом; у листа right == 0
+        uint32_t right = 0;
+    };
+
+    struct Candidate {
+        double chord_squared;
+        const Stop* stop;
+    };
+
+    static bool IsCloser(const Candidate& lhs, const Candidate& rhs);
+    uint32_t BuildNode(uint32_t begin, uint32_t end);
+    void SearchNearest(uint32_t node_index, const geo::UnitVector& center, size_t count, double& bound,
+                       std::vector<Candidate>& heap) const;
+    void SearchArea(uint32_t node_index, geo::Coordinates min, geo::Coordinates max, std::vector<const Stop*>& result) const;
+
+    std::vector<Point> points_;
+    std::vector<Node> nodes_;
+};
+
+} // namespace transport
@@ -0,0 +1,244 @@
+#include "stage_profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace profiling {
+
+namespace {
+
+const std::array<const char*, EVENT_COUNT> EVENT_NAMES = {"cycles", "instructions", "cache-miss", "branch-miss", "page-faults"};
+
+std::mutex reason_mutex;
+std::string unavailable_reason;
+
+void SetUnavailableReason(std::string reason) {
+    std::lock_guard guard(reason_mutex);
+    if (unavailable_reason.empty()) {
+        unavailable_reason = std::move(reason);
+    }
+}
+
+#if defined(__linux__)
+
+// Счётчики открываются на поток при первом использовании и считают только пользовательский код
+class ThreadCounters {
+public:
+    ThreadCounters() {
+        static const std::array<std::pair<uint32_t, uint64_t>, EVENT_COUNT> configs = {{
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+            {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        }};
+        for (size_t i = 0; i < EVENT_COUNT; ++i) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = configs[i].first;
+            attr.config = configs[i].second;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            if (fds_[i] < 0) {
+                SetUnavailableReason(std::string("perf_event_open: ") + std::strerror(errno));
+            }
+        }
+    }
+
+    ThreadCounters(const ThreadCounters&) = delete;
+    ThreadCounters& operator=(const ThreadCounters&) = delete;
+
+    ~ThreadCounters() {
+        for (const int fd : fds_) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    Readings Read() const {
+        Readings result;
+        for (size_t i = 0; i < EVENT_COUNT; ++i) {
+            uint64_t value = 0;
+            if (fds_[i] >= 0 && read(fds_[i], &value, sizeof(value)) == sizeof(value)) {
+                result[i] = value;
+            }
+        }
+        // Без perf страничные ошибки всё равно можно получить из getrusage
+        const auto page_faults = static_cast<size_t>(Event::PAGE_FAULTS);
+        if (!result[page_faults]) {
+            rusage usage;
+            if (getrusage(RUSAGE_THREAD, &usage) == 0) {
+                result[page_faults] = static_cast<uint64_t>(usage.ru_minflt + usage.ru_majflt);
+            }
+        }
+        return result;
+    }
+
+private:
+    std::array<int, EVENT_COUNT> fds_{};
+};
+
+#endif
+
+Readings Subtract(const Readings& finish, const Readings& start) {
+    Readings result;
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (start[i] && finish[i]) {
+            result[i] = *finish[i] - *start[i];
+        }
+    }
+    return result;
+}
+
+std::string FormatCount(const std::optional<uint64_t>& value) {
+    return value ? std::to_string(*value) : "n/a";
+}
+
+} // namespace
+
+Readings ReadThreadCounters() {
+#if defined(__linux__)
+    thread_local const ThreadCounters counters;
+    return counters.Read();
+#else
+    SetUnavailableReason("perf_event_open is available only on Linux");
+    return {};
+#endif
+}
+
+std::string GetUnavailableReason() {
+    std::lock_guard guard(reason_mutex);
+    return unavailable_reason;
+}
+
+StageProfiler& StageProfiler::Instance() {
+    static StageProfiler profiler;
+    return profiler;
+}
+
+void StageProfiler::Enable() {
+    enabled_.store(true, std::memory_order_relaxed);
+    ReadThreadCounters();
+}
+
+void StageProfiler::AddSample(const std::string& stage, std::chrono::nanoseconds wall_time, const Readings& delta) {
+    std::lock_guard guard(mutex_);
+    const size_t order = stages_.size();
+    auto& stats = stages_.try_emplace(stage).first->second;
+    if (stats.calls == 0) {
+        stats.order = order;
+    }
+    ++stats.calls;
+    stats.wall_time += wall_time;
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (delta[i]) {
+            stats.totals[i] = stats.totals[i].value_or(0) + *delta[i];
+        }
+    }
+}
+
+void StageProfiler::AddWorkerCounters(const Readings& delta) {
+    std::lock_guard guard(mutex_);
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (delta[i]) {
+            worker_totals_[i] = worker_totals_[i].value_or(0) + *delta[i];
+        }
+    }
+}
+
+Readings StageProfiler::GetWorkerTotals() const {
+    std::lock_guard guard(mutex_);
+    return worker_totals_;
+}
+
+void StageProfiler::PrintReport(std::ostream& out) const {
+    std::lock_guard guard(mutex_);
+    std::vector<std::pair<const std::string*, const StageStats*>> ordered;
+    for (const auto& [name, stats] : stages_) {
+        ordered.emplace_back(&name, &stats);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.second->order < rhs.second->order;
+    });
+
+    out << std::left << std::setw(20) << "stage" << std::right << std::setw(8) << "calls" << std::setw(12) << "wall_ms";
+    for (const char* name : EVENT_NAMES) {
+        out << std::setw(16) << name;
+    }
+    out << std::setw(8) << "ipc" << '\n';
+    for (const auto& [name, stats] : ordered) {
+        std::ostringstream wall_ms;
+        wall_ms << std::fixed << std::setprecision(3) << std::chrono::duration<double, std::milli>(stats->wall_time).count();
+        out << std::left << std::setw(20) << *name << std::right << std::setw(8) << stats->calls << std::setw(12) << wall_ms.str();
+        for (const auto& total : stats->totals) {
+            out << std::setw(16) << FormatCount(total);
+        }
+        const auto& cycles = stats->totals[static_cast<size_t>(Event::CYCLES)];
+        const auto& instructions = stats->totals[static_cast<size_t>(Event::INSTRUCTIONS)];
+        std::ostringstream ipc;
+        if (cycles && instructions && *cycles > 0) {
+            ipc << std::fixed << std::setprecision(2) << static_cast<double>(*instructions) / *cycles;
+        } else {
+            ipc << "n/a";
+        }
+        out << std::setw(8) << ipc.str() << '\n';
+    }
+    if (const std::string reason = GetUnavailableReason(); !reason.empty()) {
+        out << "some counters are unavailable (" << reason << ")\n";
+    }
+    out.flush();
+}
+
+ScopedStage::ScopedStage(const char* name)
+    : name_(name)
+    , active_(StageProfiler::Instance().IsEnabled()) {
+    if (active_) {
+        start_worker_totals_ = StageProfiler::Instance().GetWorkerTotals();
+        start_readings_ = ReadThreadCounters();
+        start_ = std::chrono::steady_clock::now();
+    }
+}
+
+ScopedStage::~ScopedStage() {
+    if (!active_) {
+        return;
+    }
+    const auto finish = std::chrono::steady_clock::now();
+    Readings delta = Subtract(ReadThreadCounters(), start_readings_);
+    // До первого рабочего потока сумма по ним пуста и считается нулём
+    const Readings worker_totals = StageProfiler::Instance().GetWorkerTotals();
+    for (size_t i = 0; i < EVENT_COUNT; ++i) {
+        if (delta[i] && worker_totals[i]) {
+            *delta[i] += *worker_totals[i] - start_worker_totals_[i].value_or(0);
+        }
+    }
+    StageProfiler::Instance().AddSample(name_, finish - start_, delta);
+}
+
+ScopedWorker::ScopedWorker()
+    : active_(StageProfiler::Instance().IsEnabled()) {
+    if (active_) {
+        start_readings_ = ReadThreadCounters();
+    }
+}
+
+ScopedWorker::~ScopedWorker() {
+    if (active_) {
+        StageProfiler::Instance().AddWorkerCounters(Subtract(ReadThreadCounters(), start_readings_));
+    }
+}
+
+}  // namespace profiling
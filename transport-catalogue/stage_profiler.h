@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+
+namespace profiling {
+
+// Аппаратные и программные счётчики Linux perf_event_open
+enum class Event {
+    CYCLES,
+    INSTRUCTIONS,
+    CACHE_MISSES,
+    BRANCH_MISSES,
+    PAGE_FAULTS,
+};
+
+inline constexpr size_t EVENT_COUNT = 5;
+
+// Значение отсутствует, если счётчик недоступен (нет поддержки ядра, запрет perf_event_paranoid, не Linux)
+using Readings = std::array<std::optional<uint64_t>, EVENT_COUNT>;
+
+// Профилировщик этапов: для каждого этапа накапливает число вызовов, время и приращения счётчиков.
+// Пока профилировщик не включён, ScopedStage не делает системных вызовов
+class StageProfiler {
+public:
+    static StageProfiler& Instance();
+
+    void Enable();
+    bool IsEnabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void AddSample(const std::string& stage, std::chrono::nanoseconds wall_time, const Readings& delta);
+
+    // Счётчики рабочих потоков копятся в общей сумме; этап прибавляет к своим показаниям
+    // её приращение за время своей работы
+    void AddWorkerCounters(const Readings& delta);
+    Readings GetWorkerTotals() const;
+
+    // Таблица по этапам в порядке первого завершения
+    void PrintReport(std::ostream& out) const;
+
+private:
+    struct StageStats {
+        size_t order = 0;
+        uint64_t calls = 0;
+        std::chrono::nanoseconds wall_time{0};
+        Readings totals{};
+    };
+
+    std::atomic<bool> enabled_ = false;
+    mutable std::mutex mutex_;
+    std::map<std::string, StageStats> stages_;
+    Readings worker_totals_{};
+};
+
+// Снимает показания счётчиков текущего потока
+Readings ReadThreadCounters();
+
+// Причина, по которой часть счётчиков недоступна; пустая строка, если открыты все
+std::string GetUnavailableReason();
+
+class ScopedStage {
+public:
+    explicit ScopedStage(const char* name);
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    ~ScopedStage();
+
+private:
+    const char* name_;
+    bool active_;
+    std::chrono::steady_clock::time_point start_;
+    Readings start_readings_{};
+    Readings start_worker_totals_{};
+};
+
+// Оборачивает работу потока, запущенного внутри этапа другим потоком: счётчики рабочего потока
+// попадают в открытые этапы запустившего. Сам запустивший поток оборачивать не нужно
+class ScopedWorker {
+public:
+    ScopedWorker();
+
+    ScopedWorker(const ScopedWorker&) = delete;
+    ScopedWorker& operator=(const ScopedWorker&) = delete;
+
+    ~ScopedWorker();
+
+private:
+    bool active_;
+    Readings start_readings_{};
+};
+
+}  // namespace profiling
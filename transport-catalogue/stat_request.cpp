@@ -0,0 +1,24 @@
+#include "stat_request.h"
+
+#include <array>
+
+namespace {
+
+constexpr std::array<const char*, STAT_REQUEST_KIND_COUNT> TYPE_NAMES = {
+    "Stop", "Bus", "Map", "Route", "RouteMatrix", "Isochrone", "NearestStops", "StopsInArea", "Autocomplete", "EarliestArrival", "unknown",
+};
+
+} // namespace
+
+StatRequestKind ParseStatRequestKind(std::string_view type) {
+    for (size_t i = 0; i + 1 < TYPE_NAMES.size(); ++i) {
+        if (type == TYPE_NAMES[i]) {
+            return static_cast<StatRequestKind>(i);
+        }
+    }
+    return StatRequestKind::UNKNOWN;
+}
+
+const char* GetStatRequestTypeName(StatRequestKind kind) {
+    return TYPE_NAMES[static_cast<size_t>(kind)];
+}
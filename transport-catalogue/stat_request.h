@@ -0,0 +1,59 @@
+#pragma once
+
+#include "domain.h"
+#include "geo.h"
+#include "name_index.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+enum class StatRequestKind : uint8_t {
+    STOP,
+    BUS,
+    MAP,
+    ROUTE,
+    ROUTE_MATRIX,
+    ISOCHRONE,
+    NEAREST_STOPS,
+    STOPS_IN_AREA,
+    AUTOCOMPLETE,
+    EARLIEST_ARRIVAL,
+    UNKNOWN,
+};
+
+inline constexpr size_t STAT_REQUEST_KIND_COUNT = static_cast<size_t>(StatRequestKind::UNKNOWN) + 1;
+
+StatRequestKind ParseStatRequestKind(std::string_view type);
+// Значение поля type; для UNKNOWN — "unknown"
+const char* GetStatRequestTypeName(StatRequestKind kind);
+
+// Запрос stat_requests после разбора: имена остановок и маршрутов заменены объектами каталога
+// (nullptr — нет в каталоге), необязательные поля получили значения по умолчанию.
+// Используются только поля, относящиеся к kind
+struct StatRequest {
+    StatRequestKind kind = StatRequestKind::UNKNOWN;
+    int id = 0;
+    // Stop — from; Route, Isochrone, EarliestArrival — from и to
+    const transport::Stop* from = nullptr;
+    const transport::Stop* to = nullptr;
+    const transport::Bus* bus = nullptr;
+    // Route — pareto, Isochrone — render_map
+    bool pareto = false;
+    bool render_map = false;
+    // Isochrone — max_time, EarliestArrival — departure_time
+    double time = 0.0;
+    // NearestStops — центр, StopsInArea — углы прямоугольника
+    geo::Coordinates min_coordinates{};
+    geo::Coordinates max_coordinates{};
+    std::optional<size_t> count;
+    std::optional<double> radius;
+    // Autocomplete; prefix указывает в DOM входного документа
+    std::string_view prefix;
+    size_t limit = 0;
+    std::optional<transport::NameKind> name_kind;
+    // RouteMatrix: первые from_count остановок — строки матрицы, остальные — столбцы
+    std::vector<const transport::Stop*> matrix_stops;
+    size_t from_count = 0;
+};
@@ -0,0 +1,262 @@
+#include "timetable_router.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace transport {
+
+namespace {
+
+constexpr double UNREACHED = std::numeric_limits<double>::infinity();
+constexpr uint32_t NO_ROUTE = std::numeric_limits<uint32_t>::max();
+constexpr uint32_t NO_LABEL = std::numeric_limits<uint32_t>::max();
+
+} // namespace
+
+TimetableRouter::TimetableRouter(const Settings& settings, const Catalogue& catalogue)
+    : settings_(settings) {
+    stops_.assign(catalogue.GetStopCount(), nullptr);
+    for (const Stop* stop : catalogue.GetSortedStops()) {
+        stops_[stop->id] = stop;
+    }
+    for (const Bus* bus : catalogue.GetSortedBuses()) {
+        if (bus->stops.size() < 2) {
+            continue;
+        }
+        const std::vector<double> departures = MakeDepartures(bus);
+        AddRoute(catalogue, bus, bus->stops, departures);
+        if (!bus->is_roundtrip) {
+            // Обратный рейс отправляется, как только прямой доходит до конечной
+            std::vector<double> back_departures = departures;
+            for (double& departure : back_departures) {
+                departure += stop_offsets_.back();
+            }
+            AddRoute(catalogue, bus, {bus->stops.rbegin(), bus->stops.rend()}, back_departures);
+        }
+    }
+
+    stop_route_offsets_.assign(stops_.size() + 1, 0);
+    for (const uint32_t stop : route_stops_) {
+        ++stop_route_offsets_[stop + 1];
+    }
+    for (size_t stop = 0; stop < stops_.size(); ++stop) {
+        stop_route_offsets_[stop + 1] += stop_route_offsets_[stop];
+    }
+    stop_routes_.resize(route_stops_.size());
+    std::vector<uint32_t> next(stop_route_offsets_.begin(), stop_route_offsets_.end() - 1);
+    for (uint32_t route = 0; route < routes_.size(); ++route) {
+        for (uint32_t position = 0; position < routes_[route].stop_count; ++position) {
+            const uint32_t stop = route_stops_[routes_[route].stops_begin + position];
+            stop_routes_[next[stop]++] = {route, position};
+        }
+    }
+}
+
+std::vector<double> TimetableRouter::MakeDepartures(const Bus* bus) const {
+    const BusSchedule schedule = bus->schedule.value_or(BusSchedule{0, 1440, std::max(1, 2 * settings_.bus_wait_time)});
+    std::vector<double> result;
+    if (schedule.interval <= 0) {
+        result.push_back(schedule.first_departure);
+        return result;
+    }
+    for (int departure = schedule.first_departure; departure <= schedule.last_departure; departure += schedule.interval) {
+        result.push_back(departure);
+    }
+    return result;
+}
+
+void TimetableRouter::AddRoute(const Catalogue& catalogue, const Bus* bus, const std::vector<const Stop*>& stops,
+                               const std::vector<double>& departures) {
+    const double velocity = settings_.bus_velocity * K_MH_TO_M_MIN;
+    Route route;
+    route.stops_begin = static_cast<uint32_t>(route_stops_.size());
+    route.stop_count = static_cast<uint32_t>(stops.size());
+    route.trips_begin = static_cast<uint32_t>(trip_departures_.size());
+    route.trip_count = static_cast<uint32_t>(departures.size());
+    route.bus = bus;
+    double offset = 0.0;
+    for (size_t i = 0; i < stops.size(); ++i) {
+        if (i > 0) {
+            offset += catalogue.GetStopDistance(stops[i - 1], stops[i]) / velocity;
+        }
+        route_stops_.push_back(stops[i]->id);
+        stop_offsets_.push_back(offset);
+    }
+    trip_departures_.insert(trip_departures_.end(), departures.begin(), departures.end());
+    routes_.push_back(route);
+}
+
+std::optional<uint32_t> TimetableRouter::FindEarliestTrip(const Route& route, uint32_t position, double time) const {
+    const double offset = stop_offsets_[route.stops_begin + position];
+    const auto begin = trip_departures_.begin() + route.trips_begin;
+    const auto end = begin + route.trip_count;
+    const auto it = std::partition_point(begin, end, [offset, time](double departure) {
+        return departure + offset < time;
+    });
+    if (it == end) {
+        return std::nullopt;
+    }
+    return static_cast<uint32_t>(it - begin);
+}
+
+void TimetableRouter::Scratch::Prepare(size_t stop_count, size_t route_count) {
+    for (const uint32_t stop : touched) {
+        best[stop] = UNREACHED;
+        previous_best[stop] = UNREACHED;
+        last_label[stop] = NO_LABEL;
+    }
+    for (const uint32_t stop : marked) {
+        is_marked[stop] = 0;
+    }
+    // После обычного завершения запроса маршруты уже сняты с очереди; это на случай исключения
+    for (const uint32_t route : queued_routes) {
+        route_start[route] = NO_ROUTE;
+    }
+    touched.clear();
+    marked.clear();
+    queued_routes.clear();
+    labels.clear();
+    if (best.size() < stop_count) {
+        best.resize(stop_count, UNREACHED);
+        previous_best.resize(stop_count, UNREACHED);
+        last_label.resize(stop_count, NO_LABEL);
+        is_marked.resize(stop_count, 0);
+    }
+    if (route_start.size() < route_count) {
+        route_start.resize(route_count, NO_ROUTE);
+    }
+}
+
+std::optional<TimetableRouter::Journey> TimetableRouter::FindEarliestArrival(const Stop* from, const Stop* to,
+                                                                             double departure_time) const {
+    if (from == to) {
+        return Journey{departure_time, departure_time, {}};
+    }
+    thread_local Scratch scratch;
+    scratch.Prepare(stops_.size(), routes_.size());
+    // best — лучшее прибытие с любым числом поездок, previous_best — его значение на конец прошлого раунда,
+    // то есть лучшее прибытие не более чем с round - 1 поездками
+    std::vector<double>& best = scratch.best;
+    std::vector<double>& previous_best = scratch.previous_best;
+    std::vector<uint32_t>& last_label = scratch.last_label;
+    std::vector<char>& is_marked = scratch.is_marked;
+    std::vector<uint32_t>& route_start = scratch.route_start;
+    std::vector<uint32_t>& marked = scratch.marked;
+    std::vector<uint32_t>& queued_routes = scratch.queued_routes;
+    std::vector<Label>& labels = scratch.labels;
+    const uint32_t source = from->id;
+    const uint32_t target = to->id;
+    best[source] = departure_time;
+    scratch.touched.push_back(source);
+    marked.push_back(source);
+    is_marked[source] = 1;
+
+    size_t round = 1;
+    for (; round <= MAX_ROUNDS && !marked.empty(); ++round) {
+        // Каждый маршрут просматривается один раз, начиная с самой ранней улучшенной остановки
+        queued_routes.clear();
+        for (const uint32_t stop : marked) {
+            is_marked[stop] = 0;
+            previous_best[stop] = best[stop];
+            for (uint32_t i = stop_route_offsets_[stop]; i < stop_route_offsets_[stop + 1]; ++i) {
+                const auto [route, position] = stop_routes_[i];
+                if (route_start[route] == NO_ROUTE) {
+                    queued_routes.push_back(route);
+                    route_start[route] = position;
+                } else {
+                    route_start[route] = std::min(route_start[route], position);
+                }
+            }
+        }
+        marked.clear();
+
+        for (const uint32_t route_index : queued_routes) {
+            const Route& route = routes_[route_index];
+            const double* departures = trip_departures_.data() + route.trips_begin;
+            const uint32_t start = route_start[route_index];
+            route_start[route_index] = NO_ROUTE;
+            std::optional<uint32_t> trip;
+            uint32_t board_position = 0;
+            for (uint32_t position = start; position < route.stop_count; ++position) {
+                const uint32_t stop = route_stops_[route.stops_begin + position];
+                const double offset = stop_offsets_[route.stops_begin + position];
+                if (trip) {
+                    const double arrival = departures[*trip] + offset;
+                    if (arrival < std::min(best[stop], best[target])) {
+                        if (best[stop] == UNREACHED) {
+                            scratch.touched.push_back(stop);
+                        }
+                        // Метки хранятся только для улучшенных остановок; повторное улучшение в том же раунде
+                        // переписывает метку раунда
+                        if (last_label[stop] == NO_LABEL || labels[last_label[stop]].round != round) {
+                            labels.push_back({static_cast<uint32_t>(round), 0, 0, 0, 0, last_label[stop]});
+                            last_label[stop] = static_cast<uint32_t>(labels.size() - 1);
+                        }
+                        Label& label = labels[last_label[stop]];
+                        label.route = route_index;
+                        label.trip = *trip;
+                        label.board_position = board_position;
+                        label.alight_position = position;
+                        best[stop] = arrival;
+                        if (!is_marked[stop]) {
+                            is_marked[stop] = 1;
+                            marked.push_back(stop);
+                        }
+                    }
+                }
+                // Пересесть на более ранний рейс того же маршрута можно, только если на остановку
+                // успели раньше, чем туда приходит предыдущий рейс
+                const double arrival = previous_best[stop];
+                if (arrival == UNREACHED || (trip && (*trip == 0 || departures[*trip - 1] + offset < arrival))) {
+                    continue;
+                }
+                if (const auto earliest = FindEarliestTrip(route, position, arrival); earliest && (!trip || *earliest < *trip)) {
+                    trip = earliest;
+                    board_position = position;
+                }
+            }
+        }
+    }
+
+    if (best[target] == UNREACHED) {
+        return std::nullopt;
+    }
+    Journey journey{departure_time, best[target], {}};
+    // Для остановки берётся метка самого позднего раунда, не превышающего текущий
+    uint32_t stop = target;
+    for (size_t max_round = round - 1; stop != source;) {
+        uint32_t label_index = last_label[stop];
+        while (labels[label_index].round > max_round) {
+            label_index = labels[label_index].previous;
+        }
+        const Label& label = labels[label_index];
+        const Route& route = routes_[label.route];
+        const uint32_t board_stop = route_stops_[route.stops_begin + label.board_position];
+        const double trip_departure = trip_departures_[route.trips_begin + label.trip];
+        journey.legs.push_back({route.bus, stops_[board_stop], stops_[stop],
+                                trip_departure + stop_offsets_[route.stops_begin + label.board_position],
+                                trip_departure + stop_offsets_[route.stops_begin + label.alight_position],
+                                label.alight_position - label.board_position});
+        stop = board_stop;
+        max_round = label.round - 1;
+    }
+    std::reverse(journey.legs.begin(), journey.legs.end());
+    return journey;
+}
+
+size_t TimetableRouter::GetRouteCount() const {
+    return routes_.size();
+}
+
+size_t TimetableRouter::GetTripCount() const {
+    return trip_departures_.size();
+}
+
+memory::Usage TimetableRouter::GetMemoryUsage() const {
+    return memory::EstimateVectorBuffer(stops_) + memory::EstimateVectorBuffer(routes_)
+        + memory::EstimateVectorBuffer(route_stops_) + memory::EstimateVectorBuffer(stop_offsets_)
+        + memory::EstimateVectorBuffer(trip_departures_) + memory::EstimateVectorBuffer(stop_route_offsets_)
+        + memory::EstimateVectorBuffer(stop_routes_);
+}
+
+} // namespace transport
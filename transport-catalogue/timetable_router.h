@@ -0,0 +1,112 @@
+#pragma once
+
+#include "domain.h"
+#include "memory_usage.h"
+#include "transport_catalogue.h"
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace transport {
+
+// Поиск самого раннего прибытия по расписанию в духе RAPTOR: раунд k просматривает маршруты
+// через остановки, улучшенные в раунде k - 1, и находит прибытия не более чем с k поездками.
+// Граф не строится; рейсы лежат в плоских таблицах маршрутов, отправлений и смещений
+class TimetableRouter {
+public:
+    struct Settings {
+        int bus_wait_time = 0;
+        double bus_velocity = 0.0;
+    };
+
+    // Поездка на одном рейсе; времена в минутах от начала суток
+    struct Leg {
+        const Bus* bus = nullptr;
+        const Stop* from = nullptr;
+        const Stop* to = nullptr;
+        double departure_time = 0.0;
+        double arrival_time = 0.0;
+        size_t span_count = 0;
+    };
+
+    struct Journey {
+        double departure_time = 0.0;
+        double arrival_time = 0.0;
+        std::vector<Leg> legs;
+    };
+
+    static constexpr size_t MAX_ROUNDS = 16;
+
+    TimetableRouter() = default;
+    TimetableRouter(const Settings& settings, const Catalogue& catalogue);
+
+    std::optional<Journey> FindEarliestArrival(const Stop* from, const Stop* to, double departure_time) const;
+
+    size_t GetRouteCount() const;
+    size_t GetTripCount() const;
+    memory::Usage GetMemoryUsage() const;
+
+private:
+    // Маршрут — последовательность остановок одного направления автобуса. Рейсы маршрута
+    // отличаются только временем отправления, поэтому время рейса trip на позиции i равно
+    // trip_departures_[trips_begin + trip] + stop_offsets_[stops_begin + i]
+    struct Route {
+        uint32_t stops_begin = 0;
+        uint32_t stop_count = 0;
+        uint32_t trips_begin = 0;
+        uint32_t trip_count = 0;
+        const Bus* bus = nullptr;
+    };
+
+    struct StopRoute {
+        uint32_t route = 0;
+        uint32_t position = 0;
+    };
+
+    // Рейс, которым остановка достигнута в раунде round; previous — метка той же остановки
+    // из более раннего раунда
+    struct Label {
+        uint32_t round = 0;
+        uint32_t route = 0;
+        uint32_t trip = 0;
+        uint32_t board_position = 0;
+        uint32_t alight_position = 0;
+        uint32_t previous = 0;
+    };
+
+    // Рабочие массивы запроса, свои у каждого потока и общие для всех маршрутизаторов. Между
+    // запросами массивы по остановкам и маршрутам хранят значения «не достигнута» и «не в очереди»;
+    // следующий запрос сбрасывает только записи из touched и marked, поэтому его стоимость
+    // зависит от числа затронутых остановок, а не от размера расписания
+    struct Scratch {
+        std::vector<double> best;
+        std::vector<double> previous_best;
+        std::vector<uint32_t> last_label;
+        std::vector<char> is_marked;
+        std::vector<uint32_t> route_start;
+        std::vector<uint32_t> touched;
+        std::vector<uint32_t> marked;
+        std::vector<uint32_t> queued_routes;
+        std::vector<Label> labels;
+
+        void Prepare(size_t stop_count, size_t route_count);
+    };
+
+    void AddRoute(const Catalogue& catalogue, const Bus* bus, const std::vector<const Stop*>& stops,
+                  const std::vector<double>& departures);
+    std::vector<double> MakeDepartures(const Bus* bus) const;
+    std::optional<uint32_t> FindEarliestTrip(const Route& route, uint32_t position, double time) const;
+
+    Settings settings_;
+    std::vector<const Stop*> stops_;
+    std::vector<Route> routes_;
+    std::vector<uint32_t> route_stops_;
+    std::vector<double> stop_offsets_;
+    std::vector<double> trip_departures_;
+    // Маршруты через остановку в CSR: stop_routes_[stop_route_offsets_[stop], stop_route_offsets_[stop + 1])
+    std::vector<uint32_t> stop_route_offsets_;
+    std::vector<StopRoute> stop_routes_;
+};
+
+} // namespace transport
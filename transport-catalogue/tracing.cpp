@@ -0,0 +1,95 @@
+#include "tracing.h"
+
+#ifdef TC_ENABLE_TRACING
+
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tracing {
+
+namespace {
+
+struct Span {
+    std::string name;
+    int64_t start_us;
+    int64_t duration_us;
+};
+
+struct ThreadBuffer {
+    uint64_t thread_id;
+    std::vector<Span> spans;
+};
+
+// Каждый поток пишет в свой буфер без блокировок; мьютекс нужен только
+// при регистрации нового потока и при выгрузке
+struct Collector {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+// Отсчёт времени ведётся от запуска программы
+const std::chrono::steady_clock::time_point trace_origin = std::chrono::steady_clock::now();
+
+Collector& GetCollector() {
+    static Collector collector;
+    return collector;
+}
+
+ThreadBuffer& GetThreadBuffer() {
+    thread_local ThreadBuffer* buffer = [] {
+        auto& collector = GetCollector();
+        std::lock_guard guard(collector.mutex);
+        const uint64_t thread_id = collector.buffers.size() + 1;
+        collector.buffers.push_back(std::make_unique<ThreadBuffer>(ThreadBuffer{thread_id, {}}));
+        return collector.buffers.back().get();
+    }();
+    return *buffer;
+}
+
+void PrintEscaped(std::ostream& out, const std::string& text) {
+    for (const char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+
+} // namespace
+
+void RecordSpan(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point finish) {
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    GetThreadBuffer().spans.push_back({std::move(name),
+                                       duration_cast<microseconds>(start - trace_origin).count(),
+                                       duration_cast<microseconds>(finish - start).count()});
+}
+
+bool WriteTrace(const std::string& path) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    auto& collector = GetCollector();
+    std::lock_guard guard(collector.mutex);
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for (const auto& buffer : collector.buffers) {
+        for (const auto& span : buffer->spans) {
+            out << (first ? "\n" : ",\n") << "{\"name\":\"";
+            PrintEscaped(out, span.name);
+            out << "\",\"cat\":\"tc\",\"ph\":\"X\",\"ts\":" << span.start_us << ",\"dur\":" << span.duration_us
+                << ",\"pid\":1,\"tid\":" << buffer->thread_id << '}';
+            first = false;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    return static_cast<bool>(out);
+}
+
+}  // namespace tracing
+
+#endif
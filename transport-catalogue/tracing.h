@@ -0,0 +1,52 @@
+#pragma once
+
+// Трассировка этапов в формате Chrome trace-event (chrome://tracing, ui.perfetto.dev).
+// Включается макросом TC_ENABLE_TRACING при сборке, без него все макросы
+// раскрываются в пустоту и не оставляют в программе ни кода, ни данных
+
+#ifdef TC_ENABLE_TRACING
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace tracing {
+
+// Записывает завершённый интервал в буфер текущего потока
+void RecordSpan(std::string name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point finish);
+
+// Сохраняет все накопленные интервалы в файл; вызывать после завершения рабочих потоков
+bool WriteTrace(const std::string& path);
+
+class ScopedSpan {
+public:
+    explicit ScopedSpan(std::string name)
+        : name_(std::move(name))
+        , start_(std::chrono::steady_clock::now()) {
+    }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+    ~ScopedSpan() {
+        RecordSpan(std::move(name_), start_, std::chrono::steady_clock::now());
+    }
+
+private:
+    std::string name_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace tracing
+
+#define TC_TRACE_CONCAT_IMPL(a, b) a##b
+#define TC_TRACE_CONCAT(a, b) TC_TRACE_CONCAT_IMPL(a, b)
+#define TC_TRACE_SCOPE(name) ::tracing::ScopedSpan TC_TRACE_CONCAT(tc_trace_span_, __LINE__)(name)
+#define TC_TRACE_WRITE(path) ::tracing::WriteTrace(path)
+
+#else
+
+#define TC_TRACE_SCOPE(name) ((void)0)
+#define TC_TRACE_WRITE(path) ((void)0)
+
+#endif
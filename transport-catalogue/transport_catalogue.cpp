@@ -1,10 +1,14 @@
 #include "transport_catalogue.h"
 
+#include <algorithm>
+
 namespace transport {
 
 void Catalogue::AddStop(std::string_view stop_name, const geo::Coordinates coordinates) {
-    stops_.push_back({ std::string(stop_name), coordinates, {} });
+    stops_.push_back({ std::string(stop_name), coordinates, static_cast<uint32_t>(stop_vectors_.Add(coordinates)) });
     stopname_to_stop_[stops_.back().name] = &stops_.back();
+    sorted_stops_.push_back(&stops_.back());
+    indexes_built_ = false;
 }
 
 const Stop* Catalogue::FindStop(std::string_view stop_name) const {
@@ -13,14 +17,12 @@ const Stop* Catalogue::FindStop(std::string_view stop_name) const {
     } else return nullptr;
 }    
     
-void Catalogue::AddBus(std::string_view bus_number, const std::vector<const Stop*> stops, bool is_circle) {
-    buses_.push_back({ std::string(bus_number), stops, is_circle });
+void Catalogue::AddBus(std::string_view bus_number, const std::vector<const Stop*> stops, bool is_circle,
+                       std::optional<BusSchedule> schedule) {
+    buses_.push_back({ std::string(bus_number), stops, is_circle, static_cast<uint32_t>(buses_.size()), schedule });
     busname_to_bus_[buses_.back().number] = &buses_.back();
-    for (const auto& route_stop : stops) {
-        for (auto& stop_ : stops_) {
-            if (stop_.name == route_stop->name) stop_.buses.insert(std::string(bus_number));
-        }
-    }
+    sorted_buses_.push_back(&buses_.back());
+    indexes_built_ = false;
 }
     
 const Bus* Catalogue::FindBus(std::string_view bus_number) const {
@@ -29,10 +31,22 @@ const Bus* Catalogue::FindBus(std::string_view bus_number) const {
     } else return nullptr;
 }
 
+const Stop* Catalogue::FindStop(uint32_t id) const {
+    return id < stops_.size() ? &stops_[id] : nullptr;
+}
+
+const Bus* Catalogue::FindBus(uint32_t id) const {
+    return id < buses_.size() ? &buses_[id] : nullptr;
+}
+
 size_t Catalogue::GetNumberOfUniqueStops(std::string_view bus_number) const {
-    std::unordered_set<std::string_view> unique_stops;
-    for (const auto& stop : busname_to_bus_.at(bus_number)->stops) {
-        unique_stops.insert(stop->name);
+    return GetNumberOfUniqueStops(busname_to_bus_.at(bus_number));
+}
+
+size_t Catalogue::GetNumberOfUniqueStops(const Bus* bus) const {
+    std::unordered_set<const Stop*> unique_stops;
+    for (const Stop* stop : bus->stops) {
+        unique_stops.insert(stop);
     }
     return unique_stops.size();
 }
@@ -47,20 +61,123 @@ int Catalogue::GetStopDistance(const Stop* from, const Stop* to) const {
     else return 0;
 }
 
-const std::map<std::string_view, const Bus*> Catalogue::GetSortedBuses() const {
-    std::map<std::string_view, const Bus*> result;
-    for (const auto& bus : busname_to_bus_) {
-        result.emplace(bus);
+size_t Catalogue::GetStopCount() const {
+    return stops_.size();
+}
+
+size_t Catalogue::GetBusCount() const {
+    return buses_.size();
+}
+
+size_t Catalogue::GetStopDistanceCount() const {
+    return stop_distances_.size();
+}
+
+const geo::UnitVectors& Catalogue::GetStopVectors() const {
+    return stop_vectors_;
+}
+
+void Catalogue::BuildIndexes() {
+    std::sort(sorted_stops_.begin(), sorted_stops_.end(), [](const Stop* lhs, const Stop* rhs) {
+        return lhs->name < rhs->name;
+    });
+    std::sort(sorted_buses_.begin(), sorted_buses_.end(), [](const Bus* lhs, const Bus* rhs) {
+        return lhs->number < rhs->number;
+    });
+    std::vector<std::string_view> stop_names;
+    stop_names.reserve(stops_.size());
+    for (const Stop& stop : stops_) {
+        stop_names.push_back(stop.name);
+    }
+    std::vector<std::string_view> bus_names;
+    bus_names.reserve(buses_.size());
+    for (const Bus& bus : buses_) {
+        bus_names.push_back(bus.number);
     }
-    return result;
+    spatial_index_.Build(sorted_stops_);
+    name_index_.Build(stop_names, bus_names);
+    BuildStopBuses();
+    indexes_built_ = true;
+}
+
+// Маршруты обходятся в порядке номеров, поэтому у каждой остановки они сразу отсортированы;
+// повторный проход маршрута через остановку отсекается по последнему записанному маршруту
+void Catalogue::BuildStopBuses() {
+    constexpr uint32_t NO_BUS = UINT32_MAX;
+    std::vector<uint32_t> last_bus(stops_.size(), NO_BUS);
+    stop_bus_offsets_.assign(stops_.size() + 1, 0);
+    for (const Bus* bus : sorted_buses_) {
+        for (const Stop* stop : bus->stops) {
+            if (last_bus[stop->id] != bus->id) {
+                last_bus[stop->id] = bus->id;
+                ++stop_bus_offsets_[stop->id + 1];
+            }
+        }
+    }
+    for (size_t i = 1; i < stop_bus_offsets_.size(); ++i) {
+        stop_bus_offsets_[i] += stop_bus_offsets_[i - 1];
+    }
+    stop_buses_.assign(stop_bus_offsets_.back(), nullptr);
+    std::vector<uint32_t> position(stop_bus_offsets_.begin(), stop_bus_offsets_.end() - 1);
+    last_bus.assign(stops_.size(), NO_BUS);
+    for (const Bus* bus : sorted_buses_) {
+        for (const Stop* stop : bus->stops) {
+            if (last_bus[stop->id] != bus->id) {
+                last_bus[stop->id] = bus->id;
+                stop_buses_[position[stop->id]++] = bus;
+            }
+        }
+    }
+}
+
+const StopSpatialIndex& Catalogue::GetSpatialIndex() const {
+    return spatial_index_;
+}
+
+const NamePrefixIndex& Catalogue::GetNameIndex() const {
+    return name_index_;
+}
+
+void Catalogue::CollectMemoryUsage(memory::Report& report) const {
+    memory::Usage stops = memory::EstimateDequeBuffer(stops_);
+    for (const Stop& stop : stops_) {
+        stops += memory::EstimateString(stop.name);
+    }
+    memory::Usage buses = memory::EstimateDequeBuffer(buses_);
+    for (const Bus& bus : buses_) {
+        buses += memory::EstimateString(bus.number);
+        buses += memory::EstimateVectorBuffer(bus.stops);
+    }
+    report.push_back({"catalogue.stops", stops});
+    report.push_back({"catalogue.buses", buses});
+    report.push_back({"catalogue.stop_vectors", memory::Usage{3 * stop_vectors_.GetSize() * sizeof(double), 3}});
+    report.push_back({"catalogue.name_index", memory::EstimateHashNodes(stopname_to_stop_) + memory::EstimateHashNodes(busname_to_bus_)});
+    report.push_back({"catalogue.sorted_index", memory::EstimateVectorBuffer(sorted_stops_) + memory::EstimateVectorBuffer(sorted_buses_)});
+    report.push_back({"catalogue.stop_buses", memory::EstimateVectorBuffer(stop_bus_offsets_) + memory::EstimateVectorBuffer(stop_buses_)});
+    report.push_back({"catalogue.stop_distances", memory::EstimateHashNodes(stop_distances_)});
+    report.push_back({"catalogue.spatial_index", spatial_index_.GetMemoryUsage()});
+    report.push_back({"catalogue.name_index_prefix", name_index_.GetMemoryUsage()});
+}
+
+const std::vector<const Bus*>& Catalogue::GetSortedBuses() const {
+    if (!indexes_built_) {
+        throw std::logic_error("Catalogue indexes are not built");
+    }
+    return sorted_buses_;
 }
     
-const std::map<std::string_view, const Stop*> Catalogue::GetSortedStops() const {
-    std::map<std::string_view, const Stop*> result;
-    for (const auto& stop : stopname_to_stop_) {
-        result.emplace(stop);
+const std::vector<const Stop*>& Catalogue::GetSortedStops() const {
+    if (!indexes_built_) {
+        throw std::logic_error("Catalogue indexes are not built");
     }
-    return result;
-}    
+    return sorted_stops_;
+}
+
+Catalogue::BusesRange Catalogue::GetBusesOnStop(const Stop* stop) const {
+    if (!indexes_built_) {
+        throw std::logic_error("Catalogue indexes are not built");
+    }
+    return BusesRange(stop_buses_.begin() + stop_bus_offsets_[stop->id], stop_buses_.begin() + stop_bus_offsets_[stop->id + 1]);
+}
 
 } // namespace transport
@@ -1,7 +1,12 @@
 #pragma once
 
 #include "geo.h"
+#include "geo_batch.h"
 #include "domain.h"
+#include "memory_usage.h"
+#include "name_index.h"
+#include "ranges.h"
+#include "spatial_index.h"
 
 #include <deque>
 #include <map>
@@ -20,13 +25,32 @@ public:
     
     void AddStop(std::string_view stop_name, const geo::Coordinates coordinates);
     const Stop* FindStop(std::string_view stop_name) const;
-    void AddBus(std::string_view bus_number, const std::vector<const Stop*> stops, bool is_circle);
+    void AddBus(std::string_view bus_number, const std::vector<const Stop*> stops, bool is_circle,
+                std::optional<BusSchedule> schedule = std::nullopt);
     const Bus* FindBus(std::string_view bus_number) const;
+    // По Stop::id и Bus::id; nullptr, если номера нет в каталоге
+    const Stop* FindStop(uint32_t id) const;
+    const Bus* FindBus(uint32_t id) const;
     size_t GetNumberOfUniqueStops(std::string_view bus_number) const;
+    size_t GetNumberOfUniqueStops(const Bus* bus) const;
     void SetStopDistance(const Stop* from, const Stop* to, const int distance);
     int GetStopDistance(const Stop* from, const Stop* to) const;
-    const std::map<std::string_view, const Bus*> GetSortedBuses() const;
-    const std::map<std::string_view, const Stop*> GetSortedStops() const;
+    size_t GetStopCount() const;
+    size_t GetBusCount() const;
+    size_t GetStopDistanceCount() const;
+    void CollectMemoryUsage(memory::Report& report) const;
+    // Единичные векторы остановок в порядке Stop::id
+    const geo::UnitVectors& GetStopVectors() const;
+    // Индексы строятся после заполнения каталога и перестраиваются повторным вызовом
+    void BuildIndexes();
+    const StopSpatialIndex& GetSpatialIndex() const;
+    const NamePrefixIndex& GetNameIndex() const;
+    // Упорядочены по имени; доступны после BuildIndexes
+    const std::vector<const Bus*>& GetSortedBuses() const;
+    const std::vector<const Stop*>& GetSortedStops() const;
+    using BusesRange = ranges::Range<std::vector<const Bus*>::const_iterator>;
+    // Маршруты через остановку в порядке номеров; доступны после BuildIndexes
+    BusesRange GetBusesOnStop(const Stop* stop) const;
     struct StopDistancesHasher {
         size_t operator()(const std::pair<const Stop*, const Stop*>& points) const {
             size_t hash_first = std::hash<const void*>{}(points.first);
@@ -36,10 +60,22 @@ public:
     };
        
 private:
+    void BuildStopBuses();
+
     std::deque<Bus> buses_;
     std::unordered_map<std::string_view, const Bus*> busname_to_bus_;
     std::deque<Stop> stops_;    
     std::unordered_map<std::string_view, const Stop*> stopname_to_stop_;
+    geo::UnitVectors stop_vectors_;
+    std::vector<const Bus*> sorted_buses_;
+    std::vector<const Stop*> sorted_stops_;
+    // Индекс остановка -> маршруты в формате CSR: маршруты остановки с id i лежат
+    // в stop_buses_ на позициях [stop_bus_offsets_[i], stop_bus_offsets_[i + 1])
+    std::vector<uint32_t> stop_bus_offsets_;
+    std::vector<const Bus*> stop_buses_;
+    bool indexes_built_ = false;
+    StopSpatialIndex spatial_index_;
+    NamePrefixIndex name_index_;
     std::unordered_map<std::pair<const Stop*, const Stop*>, int, StopDistancesHasher> stop_distances_;
 };
 
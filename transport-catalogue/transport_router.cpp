@@ -1,22 +1,58 @@
 #include "transport_router.h"
+#include "metrics.h"
+#include "stage_profiler.h"
+#include "tracing.h"
+
+#include <algorithm>
+#include <tuple>
 
 namespace transport {
 
-const graph::DirectedWeightedGraph<double>& TransportRouter::BuildGraph(const Catalogue& catalogue) {
-    BuildStopsGraph(catalogue);
-    BuildBusesGraph(catalogue);
+const RouteGraph& TransportRouter::BuildGraph(const Catalogue& catalogue) {
+    if (settings_.graph_model == GraphModel::CHAINED) {
+        {
+            TC_TRACE_SCOPE("BuildGraph");
+            profiling::ScopedStage stage("graph_build");
+            BuildStopsGraph(catalogue, CountRideVertices(catalogue));
+            BuildBusesChainedGraph(catalogue);
+        }
+        TC_TRACE_SCOPE("RouterPreprocessing");
+        profiling::ScopedStage stage("router_preprocess");
+        router_ = std::make_unique<RouteRouter>(graph_, graph::RoutingMode::ON_DEMAND);
+    } else {
+        {
+            TC_TRACE_SCOPE("BuildGraph");
+            profiling::ScopedStage stage("graph_build");
+            BuildStopsGraph(catalogue, 0);
+            BuildBusesGraph(catalogue);
+        }
+        TC_TRACE_SCOPE("RouterPreprocessing");
+        profiling::ScopedStage stage("router_preprocess");
+        const auto mode = settings_.all_pairs_algorithm == AllPairsAlgorithm::BLOCKED
+            ? graph::RoutingMode::ALL_PAIRS_BLOCKED
+            : graph::RoutingMode::ALL_PAIRS;
+        router_ = std::make_unique<RouteRouter>(graph_, mode);
+    }
+    is_boarding_edge_.assign(graph_.GetEdgeCount(), 0);
+    for (RouteId edge_id = 0; edge_id < graph_.GetEdgeCount(); ++edge_id) {
+        is_boarding_edge_[edge_id] = graph_.GetEdge(edge_id).type == "Stop";
+    }
     return graph_;
 }
 
-void TransportRouter::BuildStopsGraph(const Catalogue& catalogue) {
+void TransportRouter::BuildStopsGraph(const Catalogue& catalogue, size_t ride_vertex_count) {
     const auto& all_stops = catalogue.GetSortedStops();
-    graph::DirectedWeightedGraph<double> graph_stops(all_stops.size() * 2);
-    std::map<std::string, graph::VertexId> stop_id;
-    graph::VertexId vertex_id = 0;
+    RouteGraph graph_stops(all_stops.size() * 2 + ride_vertex_count);
+    std::map<std::string, RouteId, std::less<>> stop_id;
+    RouteId vertex_id = 0;
     std::string type = "Stop";
-    for (const auto& [stop_name, info] : all_stops) {
+    stop_vertex_.assign(catalogue.GetStopCount(), 0);
+    vertex_stop_.assign(graph_stops.GetVertexCount(), nullptr);
+    for (const Stop* info : all_stops) {
         stop_id[info->name] = vertex_id;
-        graph_stops.AddEdge({type, vertex_id, ++vertex_id, static_cast<double>(settings_.bus_wait_time)});
+        stop_vertex_[info->id] = vertex_id;
+        vertex_stop_[vertex_id] = info;
+        graph_stops.AddEdge({type, vertex_id, ++vertex_id, ToRouteWeight(settings_.bus_wait_time)});
         ++vertex_id;
     }
     graph_ = std::move(graph_stops);
@@ -25,7 +61,7 @@ void TransportRouter::BuildStopsGraph(const Catalogue& catalogue) {
 
 void TransportRouter::BuildBusesGraph(const Catalogue& catalogue) {
     const auto& all_buses = catalogue.GetSortedBuses();
-    for (const auto& [_, info] : all_buses) {
+    for (const Bus* info : all_buses) {
         const auto& stops = info->stops;
         size_t stops_count = stops.size();
         std::string type = "Bus";
@@ -39,21 +75,135 @@ void TransportRouter::BuildBusesGraph(const Catalogue& catalogue) {
                     dist += catalogue.GetStopDistance(stops[k - 1], stops[k]); 
                     dist_reverse += catalogue.GetStopDistance(stops[k], stops[k - 1]);
                 }
-                graph_.AddEdge({type, stop_id_.at(stop_from->name) + 1, stop_id_.at(stop_to->name), static_cast<double>(dist) / (settings_.bus_velocity * K_MH_TO_M_MIN)});
+                graph_.AddEdge({type, stop_vertex_[stop_from->id] + 1, stop_vertex_[stop_to->id], ToRouteWeight(static_cast<double>(dist) / (settings_.bus_velocity * K_MH_TO_M_MIN))});
                 if (!info->is_roundtrip) {
-                    graph_.AddEdge({type, stop_id_.at(stop_to->name) + 1, stop_id_.at(stop_from->name), static_cast<double>(dist_reverse) / (settings_.bus_velocity * K_MH_TO_M_MIN)});
+                    graph_.AddEdge({type, stop_vertex_[stop_to->id] + 1, stop_vertex_[stop_from->id], ToRouteWeight(static_cast<double>(dist_reverse) / (settings_.bus_velocity * K_MH_TO_M_MIN))});
                 }
             }
         }
     }
-    router_ = std::make_unique<graph::Router<double>>(graph_);
 }
 
-const std::optional<graph::Router<double>::RouteInfo> TransportRouter::FindRoute(const std::string_view stop_from, const std::string_view stop_to) const {
-	return router_->BuildRoute(stop_id_.at(std::string(stop_from)),stop_id_.at(std::string(stop_to)));
+void TransportRouter::BuildTimetable(const Catalogue& catalogue) {
+    TC_TRACE_SCOPE("BuildTimetable");
+    profiling::ScopedStage stage("timetable_build");
+    timetable_ = TimetableRouter({settings_.bus_wait_time, settings_.bus_velocity}, catalogue);
 }
 
-const graph::DirectedWeightedGraph<double>& TransportRouter::GetGraph() const {
+size_t TransportRouter::CountRideVertices(const Catalogue& catalogue) const {
+    size_t result = 0;
+    for (const Bus* info : catalogue.GetSortedBuses()) {
+        result += info->is_roundtrip ? info->stops.size() : info->stops.size() * 2;
+    }
+    return result;
+}
+
+void TransportRouter::BuildBusesChainedGraph(const Catalogue& catalogue) {
+    RouteId ride_vertex = static_cast<RouteId>(stop_id_.size() * 2);
+    const double velocity = settings_.bus_velocity * K_MH_TO_M_MIN;
+    auto add_ride = [&](const std::vector<const Stop*>& stops) {
+        for (size_t i = 0; i < stops.size(); ++i, ++ride_vertex) {
+            const RouteId stop_vertex = stop_vertex_[stops[i]->id];
+            if (i + 1 < stops.size()) {
+                graph_.AddEdge({"Board", stop_vertex + 1, ride_vertex, ToRouteWeight(0.0)});
+                const int dist = catalogue.GetStopDistance(stops[i], stops[i + 1]);
+                graph_.AddEdge({"Bus", ride_vertex, ride_vertex + 1, ToRouteWeight(static_cast<double>(dist) / velocity)});
+            }
+            if (i > 0) {
+                graph_.AddEdge({"Alight", ride_vertex, stop_vertex, ToRouteWeight(0.0)});
+            }
+        }
+    };
+    for (const Bus* info : catalogue.GetSortedBuses()) {
+        add_ride(info->stops);
+        if (!info->is_roundtrip) {
+            add_ride({info->stops.rbegin(), info->stops.rend()});
+        }
+    }
+}
+
+const std::optional<TransportRouter::RouteInfo> TransportRouter::FindRoute(const Stop* stop_from, const Stop* stop_to) const {
+    static metrics::Counter& queries = metrics::Registry::Instance().GetCounter("tc_router_queries_total", "kind=\"route\"");
+    queries.Add();
+	return router_->BuildRoute(GetStopId(stop_from), GetStopId(stop_to));
+}
+
+std::vector<graph::ParetoRoute<RouteWeight, RouteId>> TransportRouter::FindParetoRoutes(const Stop* stop_from, const Stop* stop_to) const {
+    static metrics::Counter& queries = metrics::Registry::Instance().GetCounter("tc_router_queries_total", "kind=\"pareto\"");
+    queries.Add();
+    return graph::FindParetoRoutes(graph_, GetStopId(stop_from), GetStopId(stop_to), [this](RouteId edge_id) {
+        return is_boarding_edge_[edge_id] != 0;
+    });
+}
+
+std::vector<TransportRouter::TravelTimes> TransportRouter::FindTravelTimes(const std::vector<const Stop*>& stops_from, const std::vector<const Stop*>& stops_to) const {
+    std::vector<RouteId> targets;
+    targets.reserve(stops_to.size());
+    for (const Stop* stop_to : stops_to) {
+        targets.push_back(GetStopId(stop_to));
+    }
+    static metrics::Counter& queries = metrics::Registry::Instance().GetCounter("tc_router_queries_total", "kind=\"travel_times\"");
+    queries.Add(stops_from.size());
+    std::vector<TravelTimes> result;
+    result.reserve(stops_from.size());
+    for (const Stop* stop_from : stops_from) {
+        TravelTimes& times = result.emplace_back();
+        for (const auto& weight : router_->GetRouteWeights(GetStopId(stop_from), targets)) {
+            times.push_back(weight ? std::optional<double>(ToMinutes(*weight)) : std::nullopt);
+        }
+    }
+    return result;
+}
+
+std::optional<RouteId> TransportRouter::GetStopId(const std::string_view stop_name) const {
+    if (const auto it = stop_id_.find(stop_name); it != stop_id_.end()) {
+        return it->second;
+    }
+    return std::nullopt;
+}
+
+RouteId TransportRouter::GetStopId(const Stop* stop) const {
+    return stop_vertex_.at(stop->id);
+}
+
+std::vector<std::pair<const Stop*, double>> TransportRouter::FindReachableStops(const Stop* stop_from, double max_time) const {
+    static metrics::Counter& queries = metrics::Registry::Instance().GetCounter("tc_router_queries_total", "kind=\"reachable\"");
+    queries.Add();
+    std::vector<std::pair<const Stop*, double>> result;
+    for (const auto& [vertex, weight] : router_->GetReachableVertices(GetStopId(stop_from), ToRouteWeight(max_time))) {
+        if (vertex < vertex_stop_.size() && vertex_stop_[vertex] != nullptr) {
+            result.emplace_back(vertex_stop_[vertex], ToMinutes(weight));
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const auto& lhs, const auto& rhs) {
+        return std::tie(lhs.second, lhs.first->name) < std::tie(rhs.second, rhs.first->name);
+    });
+    return result;
+}
+
+const RouteGraph& TransportRouter::GetGraph() const {
 	return graph_;
 }
+
+const TimetableRouter& TransportRouter::GetTimetable() const {
+    return timetable_;
+}
+
+RouteRouter::SearchStats TransportRouter::GetSearchStats() const {
+    return router_->GetSearchStats();
+}
+
+void TransportRouter::CollectMemoryUsage(memory::Report& report) const {
+    memory::Usage stop_index = memory::EstimateTreeNodes(stop_id_) + memory::EstimateVectorBuffer(stop_vertex_)
+        + memory::EstimateVectorBuffer(vertex_stop_);
+    for (const auto& [name, id] : stop_id_) {
+        stop_index += memory::EstimateString(name);
+    }
+    report.push_back({"router.graph_edges", graph_.GetEdgesMemoryUsage() + memory::EstimateVectorBuffer(is_boarding_edge_)});
+    report.push_back({"router.graph_incidence", graph_.GetIncidenceMemoryUsage()});
+    report.push_back({"router.stop_index", stop_index});
+    report.push_back({"router.routes_table", router_->GetMemoryUsage()});
+    report.push_back({"router.timetable", timetable_.GetMemoryUsage()});
+}
+
 } // namespace transport
@@ -1,21 +1,81 @@
 #pragma once
 
+#include "pareto_router.h"
 #include "router.h"
+#include "timetable_router.h"
 #include "transport_catalogue.h"
 
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <type_traits>
 
     
 namespace transport {
 
-constexpr static double K_MH_TO_M_MIN = 1000.0 / 60.0;
-    
+// Представление весов и номеров графа маршрутов выбирается при сборке: по умолчанию double и size_t,
+// с -DTC_ROUTER_COMPACT — float и uint32_t, с -DTC_ROUTER_FIXED_POINT — целые децисекунды и uint32_t.
+// Время на входе и выходе TransportRouter всегда в минутах
+#if defined(TC_ROUTER_FIXED_POINT)
+using RouteWeight = uint32_t;
+using RouteId = uint32_t;
+inline constexpr double ROUTE_WEIGHT_PER_MINUTE = 600.0;
+#elif defined(TC_ROUTER_COMPACT)
+using RouteWeight = float;
+using RouteId = uint32_t;
+inline constexpr double ROUTE_WEIGHT_PER_MINUTE = 1.0;
+#else
+using RouteWeight = double;
+using RouteId = size_t;
+inline constexpr double ROUTE_WEIGHT_PER_MINUTE = 1.0;
+#endif
+
+using RouteGraph = graph::DirectedWeightedGraph<RouteWeight, RouteId>;
+using RouteRouter = graph::Router<RouteWeight, RouteId>;
+
+inline RouteWeight ToRouteWeight(double minutes) {
+    if constexpr (std::is_integral_v<RouteWeight>) {
+        // Вне диапазона приведение к целому переполняется, поэтому значение зажимается в [0, max]
+        const double scaled = std::round(minutes * ROUTE_WEIGHT_PER_MINUTE);
+        if (!(scaled > 0.0)) {
+            return 0;
+        }
+        if (scaled >= static_cast<double>(std::numeric_limits<RouteWeight>::max())) {
+            return std::numeric_limits<RouteWeight>::max();
+        }
+        return static_cast<RouteWeight>(scaled);
+    } else {
+        return static_cast<RouteWeight>(minutes * ROUTE_WEIGHT_PER_MINUTE);
+    }
+}
+
+inline double ToMinutes(RouteWeight weight) {
+    return static_cast<double>(weight) / ROUTE_WEIGHT_PER_MINUTE;
+}
+
+// PAIRWISE: ребро между каждой парой остановок маршрута, O(n^2) рёбер на автобус.
+// CHAINED: у каждой позиции маршрута своя вершина-поездка, соседние позиции соединены
+// цепочкой, а посадка и высадка стоят 0; O(n) рёбер на автобус, маршруты ищутся по запросу.
+enum class GraphModel {
+    PAIRWISE,
+    CHAINED,
+};
+
+// Алгоритм предрасчёта всех пар для модели PAIRWISE: CLASSIC — построчный Флойд–Уоршелл,
+// BLOCKED — блочный по плоским матрицам, многопоточный, с теми же весами маршрутов
+enum class AllPairsAlgorithm {
+    CLASSIC,
+    BLOCKED,
+};
+
 class TransportRouter {
     
 public:
     struct Settings {
         int bus_wait_time = 0;
         double bus_velocity = 0.0;
+        GraphModel graph_model = GraphModel::PAIRWISE;
+        AllPairsAlgorithm all_pairs_algorithm = AllPairsAlgorithm::CLASSIC;
     };
 
     TransportRouter() = default;
@@ -23,21 +83,45 @@ public:
     explicit TransportRouter(const Settings& settings, const Catalogue& catalogue)
         : settings_(settings) {
         BuildGraph(catalogue);
+        BuildTimetable(catalogue);
     }
     
-    using RouteInfo = graph::Router<double>::RouteInfo;
-    const std::optional<RouteInfo> FindRoute(const std::string_view stop_from, const std::string_view stop_to) const;
+    using RouteInfo = RouteRouter::RouteInfo;
+    // Остановки — объекты того же каталога, по которому построен граф
+    const std::optional<RouteInfo> FindRoute(const Stop* stop_from, const Stop* stop_to) const;
+    // Маршруты, оптимальные по Парето по времени в пути и числу посадок; пусто, если пути нет
+    std::vector<graph::ParetoRoute<RouteWeight, RouteId>> FindParetoRoutes(const Stop* stop_from, const Stop* stop_to) const;
+    std::optional<RouteId> GetStopId(const std::string_view stop_name) const;
+    RouteId GetStopId(const Stop* stop) const;
+
+    using TravelTimes = std::vector<std::optional<double>>;
+    std::vector<TravelTimes> FindTravelTimes(const std::vector<const Stop*>& stops_from, const std::vector<const Stop*>& stops_to) const;
+    // Достижимые остановки по возрастанию времени, при равном времени — по имени
+    std::vector<std::pair<const Stop*, double>> FindReachableStops(const Stop* stop_from, double max_time) const;
     
-    const graph::DirectedWeightedGraph<double>& GetGraph() const;
+    const RouteGraph& GetGraph() const;
+    // Расписание рейсов для запросов самого раннего прибытия; не зависит от graph_model
+    const TimetableRouter& GetTimetable() const;
+    RouteRouter::SearchStats GetSearchStats() const;
+    void CollectMemoryUsage(memory::Report& report) const;
 
 private:
     Settings settings_;
-    const graph::DirectedWeightedGraph<double>& BuildGraph(const Catalogue& catalogue);
-    void BuildStopsGraph(const Catalogue& catalogue);
+    const RouteGraph& BuildGraph(const Catalogue& catalogue);
+    void BuildStopsGraph(const Catalogue& catalogue, size_t ride_vertex_count);
     void BuildBusesGraph(const Catalogue& catalogue);
+    void BuildBusesChainedGraph(const Catalogue& catalogue);
+    void BuildTimetable(const Catalogue& catalogue);
+    size_t CountRideVertices(const Catalogue& catalogue) const;
     
-    graph::DirectedWeightedGraph<double> graph_;
-    std::map<std::string, graph::VertexId> stop_id_;
-    std::unique_ptr<graph::Router<double>> router_;
+    RouteGraph graph_;
+    std::map<std::string, RouteId, std::less<>> stop_id_;
+    // Вершина ожидания остановки по Stop::id и остановка по вершине ожидания
+    std::vector<RouteId> stop_vertex_;
+    std::vector<const Stop*> vertex_stop_;
+    // Ожидание на остановке предшествует каждой посадке в обеих моделях графа
+    std::vector<char> is_boarding_edge_;
+    std::unique_ptr<RouteRouter> router_;
+    TimetableRouter timetable_;
 };
 } // namespace transport
@@ -0,0 +1,81 @@
+#include "transport_snapshot.h"
+
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+namespace transport {
+
+SnapshotHolder::SnapshotHolder()
+    : current_(new Record{std::make_shared<const Snapshot>()}) {
+}
+
+SnapshotHolder::~SnapshotHolder() {
+    delete current_.load();
+    for (const Record* record : retired_) {
+        delete record;
+    }
+}
+
+std::shared_ptr<const Snapshot> SnapshotHolder::Acquire() const {
+    // Слот, с которого поток начинает поиск, фиксирован, чтобы потоки не соперничали за одни слоты
+    const size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id()) % MAX_CONCURRENT_ACQUIRES;
+    const Record* record = current_.load();
+    for (size_t i = start;; i = (i + 1) % MAX_CONCURRENT_ACQUIRES) {
+        const Record* expected = nullptr;
+        if (!hazards_[i].compare_exchange_strong(expected, record)) {
+            continue;
+        }
+        // Запись защищена, только если после объявления она всё ещё текущая: иначе писатель
+        // мог проверить слоты раньше и удалить её
+        for (const Record* latest = current_.load(); latest != record; latest = current_.load()) {
+            record = latest;
+            hazards_[i].store(record);
+        }
+        std::shared_ptr<const Snapshot> result = record->snapshot;
+        hazards_[i].store(nullptr, std::memory_order_release);
+        return result;
+    }
+}
+
+uint64_t SnapshotHolder::Publish(std::shared_ptr<const Catalogue> catalogue, std::shared_ptr<const TransportRouter> router) {
+    std::lock_guard guard(publish_mutex_);
+    const uint64_t version = ++last_version_;
+    const Record* record = new Record{std::make_shared<const Snapshot>(Snapshot{version, std::move(catalogue), std::move(router)})};
+    retired_.push_back(current_.exchange(record));
+    ReclaimLocked();
+    return version;
+}
+
+uint64_t SnapshotHolder::Publish(std::shared_ptr<const Catalogue> catalogue, const TransportRouter::Settings& settings) {
+    auto router = std::make_shared<const TransportRouter>(settings, *catalogue);
+    return Publish(std::move(catalogue), std::move(router));
+}
+
+uint64_t SnapshotHolder::GetVersion() const {
+    return Acquire()->version;
+}
+
+size_t SnapshotHolder::Reclaim() {
+    std::lock_guard guard(publish_mutex_);
+    return ReclaimLocked();
+}
+
+size_t SnapshotHolder::ReclaimLocked() {
+    const auto kept = std::partition(retired_.begin(), retired_.end(), [this](const Record* record) {
+        return IsProtected(record);
+    });
+    for (auto it = kept; it != retired_.end(); ++it) {
+        delete *it;
+    }
+    retired_.erase(kept, retired_.end());
+    return retired_.size();
+}
+
+bool SnapshotHolder::IsProtected(const Record* record) const {
+    return std::any_of(hazards_.begin(), hazards_.end(), [record](const auto& hazard) {
+        return hazard.load() == record;
+    });
+}
+
+} // namespace transport
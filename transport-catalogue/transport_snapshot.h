@@ -0,0 +1,63 @@
+#pragma once
+
+#include "transport_catalogue.h"
+#include "transport_router.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace transport {
+
+// Неизменяемая версия каталога вместе с построенным по нему маршрутизатором
+struct Snapshot {
+    uint64_t version = 0;
+    std::shared_ptr<const Catalogue> catalogue;
+    std::shared_ptr<const TransportRouter> router;
+};
+
+// Читатели берут текущий снимок без блокировок и держат его, пока обрабатывают запросы.
+// Писатель публикует новый снимок атомарной заменой указателя; старый снимок
+// освобождается, когда его отпустит последний читатель.
+//
+// Текущая версия хранится в записи, на которую указывает атомарный сырой указатель. Читатель
+// объявляет запись в слоте защиты (hazard pointer), убеждается, что она всё ещё текущая,
+// копирует из неё shared_ptr на снимок и освобождает слот. Заменённые записи откладываются
+// и удаляются писателем, когда ни один слот на них не указывает
+class SnapshotHolder {
+public:
+    // Одновременно выполняющихся Acquire больше этого числа ждут освобождения слота
+    static constexpr size_t MAX_CONCURRENT_ACQUIRES = 64;
+
+    SnapshotHolder();
+    SnapshotHolder(const SnapshotHolder&) = delete;
+    SnapshotHolder& operator=(const SnapshotHolder&) = delete;
+    ~SnapshotHolder();
+
+    std::shared_ptr<const Snapshot> Acquire() const;
+    uint64_t Publish(std::shared_ptr<const Catalogue> catalogue, std::shared_ptr<const TransportRouter> router);
+    uint64_t Publish(std::shared_ptr<const Catalogue> catalogue, const TransportRouter::Settings& settings);
+    uint64_t GetVersion() const;
+    // Удаляет заменённые записи, которые не защищены читателями; возвращает число оставшихся.
+    // Вызывается из Publish, отдельно — чтобы отпустить старые снимки без публикации новой версии
+    size_t Reclaim();
+
+private:
+    struct Record {
+        std::shared_ptr<const Snapshot> snapshot;
+    };
+
+    std::atomic<const Record*> current_;
+    mutable std::array<std::atomic<const Record*>, MAX_CONCURRENT_ACQUIRES> hazards_{};
+    std::mutex publish_mutex_;
+    uint64_t last_version_ = 0;
+    std::vector<const Record*> retired_;
+
+    size_t ReclaimLocked();
+    bool IsProtected(const Record* record) const;
+};
+
+} // namespace transport
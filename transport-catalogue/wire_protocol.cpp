@@ -0,0 +1,532 @@
+#include "wire_protocol.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace wire {
+
+namespace {
+
+enum class Tag : uint8_t {
+    NUL,
+    BOOL_FALSE,
+    BOOL_TRUE,
+    INT,
+    DOUBLE,
+    STRING,
+    ARRAY,
+    DICT,
+};
+
+// Ключи и частые строковые значения ответов; номер строки в таблице — её индекс плюс 1.
+// Новые строки добавляются только в конец, чтобы не менять номера уже известных
+constexpr std::array<std::string_view, 28> KNOWN_STRINGS = {
+    "request_id", "error_message", "not found", "buses", "curvature", "route_length", "stop_count",
+    "unique_stop_count", "map", "total_time", "items", "time", "type", "stop_name", "bus",
+    "routes", "boardings", "total_times", "stops", "distance", "matches", "name", "arrival_time",
+    "departure_time", "span_count", "Wait", "Bus", "Stop",
+};
+
+const std::unordered_map<std::string_view, uint32_t>& GetKnownStringIds() {
+    static const std::unordered_map<std::string_view, uint32_t> ids = [] {
+        std::unordered_map<std::string_view, uint32_t> result;
+        for (size_t i = 0; i < KNOWN_STRINGS.size(); ++i) {
+            result.emplace(KNOWN_STRINGS[i], static_cast<uint32_t>(i + 1));
+        }
+        return result;
+    }();
+    return ids;
+}
+
+void WriteVarint(uint64_t value, std::string& out) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+void WriteSigned(int64_t value, std::string& out) {
+    WriteVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63), out);
+}
+
+void WriteDouble(double value, std::string& out) {
+    uint64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+}
+
+void WriteBytes(std::string_view bytes, std::string& out) {
+    WriteVarint(bytes.size(), out);
+    out.append(bytes);
+}
+
+void WriteString(std::string_view text, std::string& out) {
+    const auto& ids = GetKnownStringIds();
+    if (const auto it = ids.find(text); it != ids.end()) {
+        WriteVarint(it->second, out);
+        return;
+    }
+    out.push_back(0);
+    WriteBytes(text, out);
+}
+
+template <typename Object>
+void WriteObjectId(const Object* object, std::string& out) {
+    WriteVarint(object ? uint64_t{object->id} + 1 : 0, out);
+}
+
+// Последовательное чтение содержимого кадра; выход за его границу — ProtocolError
+class Reader {
+public:
+    explicit Reader(std::string_view data)
+        : data_(data) {
+    }
+
+    uint8_t ReadByte() {
+        Require(1);
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    uint64_t ReadVarint() {
+        uint64_t result = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const uint8_t byte = ReadByte();
+            result |= uint64_t{byte & 0x7Fu} << shift;
+            if ((byte & 0x80) == 0) {
+                return result;
+            }
+        }
+        throw ProtocolError("Varint is too long");
+    }
+
+    int64_t ReadSigned() {
+        const uint64_t value = ReadVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    int ReadInt() {
+        const int64_t value = ReadSigned();
+        if (value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max()) {
+            throw ProtocolError("Integer is out of range");
+        }
+        return static_cast<int>(value);
+    }
+
+    size_t ReadSize() {
+        const uint64_t value = ReadVarint();
+        // Каждый элемент занимает хотя бы байт, поэтому размер больше остатка кадра — ошибка
+        if (value > data_.size() - pos_) {
+            throw ProtocolError("Size exceeds frame");
+        }
+        return static_cast<size_t>(value);
+    }
+
+    double ReadDouble() {
+        Require(8);
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; ++i) {
+            bits |= uint64_t{static_cast<uint8_t>(data_[pos_ + i])} << (8 * i);
+        }
+        pos_ += 8;
+        double result = 0.0;
+        std::memcpy(&result, &bits, sizeof(result));
+        return result;
+    }
+
+    std::string_view ReadBytes() {
+        const size_t size = ReadSize();
+        const std::string_view result = data_.substr(pos_, size);
+        pos_ += size;
+        return result;
+    }
+
+    std::string_view ReadString() {
+        const uint64_t id = ReadVarint();
+        if (id == 0) {
+            return ReadBytes();
+        }
+        if (id > KNOWN_STRINGS.size()) {
+            throw ProtocolError("Unknown string id");
+        }
+        return KNOWN_STRINGS[id - 1];
+    }
+
+    void ExpectEnd() const {
+        if (pos_ != data_.size()) {
+            throw ProtocolError("Unexpected bytes at the end of frame");
+        }
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+
+    void Require(size_t size) const {
+        if (data_.size() - pos_ < size) {
+            throw ProtocolError("Unexpected end of frame");
+        }
+    }
+};
+
+const transport::Stop* ReadStop(Reader& reader, const RequestHandler& rh) {
+    const uint64_t id = reader.ReadVarint();
+    return id == 0 || id > std::numeric_limits<uint32_t>::max() ? nullptr : rh.FindStop(static_cast<uint32_t>(id - 1));
+}
+
+const transport::Bus* ReadBus(Reader& reader, const RequestHandler& rh) {
+    const uint64_t id = reader.ReadVarint();
+    return id == 0 || id > std::numeric_limits<uint32_t>::max() ? nullptr : rh.FindBus(static_cast<uint32_t>(id - 1));
+}
+
+void EncodeNode(const json::Node& node, std::string& out) {
+    switch (node.GetType()) {
+    case json::Node::Type::NUL:
+        out.push_back(static_cast<char>(Tag::NUL));
+        break;
+    case json::Node::Type::BOOL:
+        out.push_back(static_cast<char>(node.AsBool() ? Tag::BOOL_TRUE : Tag::BOOL_FALSE));
+        break;
+    case json::Node::Type::INT:
+        out.push_back(static_cast<char>(Tag::INT));
+        WriteSigned(node.AsInt(), out);
+        break;
+    case json::Node::Type::DOUBLE:
+        out.push_back(static_cast<char>(Tag::DOUBLE));
+        WriteDouble(node.AsDouble(), out);
+        break;
+    case json::Node::Type::STRING:
+        out.push_back(static_cast<char>(Tag::STRING));
+        WriteString(node.AsString(), out);
+        break;
+    case json::Node::Type::ARRAY:
+        out.push_back(static_cast<char>(Tag::ARRAY));
+        WriteVarint(node.AsArray().size(), out);
+        for (const auto& item : node.AsArray()) {
+            EncodeNode(item, out);
+        }
+        break;
+    case json::Node::Type::DICT:
+        out.push_back(static_cast<char>(Tag::DICT));
+        WriteVarint(node.AsDict().size(), out);
+        for (const auto& [key, value] : node.AsDict()) {
+            WriteString(key, out);
+            EncodeNode(value, out);
+        }
+        break;
+    }
+}
+
+// Ответы вложены не глубже нескольких уровней; ограничение не даёт цепочке вложенных ARRAY
+// переполнить стек рекурсии
+constexpr size_t MAX_NESTING_DEPTH = 64;
+
+json::Node DecodeNode(Reader& reader, size_t depth = 0) {
+    const Tag tag = static_cast<Tag>(reader.ReadByte());
+    if ((tag == Tag::ARRAY || tag == Tag::DICT) && depth >= MAX_NESTING_DEPTH) {
+        throw ProtocolError("Value nesting is too deep");
+    }
+    switch (tag) {
+    case Tag::NUL:
+        return nullptr;
+    case Tag::BOOL_FALSE:
+        return false;
+    case Tag::BOOL_TRUE:
+        return true;
+    case Tag::INT:
+        return reader.ReadInt();
+    case Tag::DOUBLE:
+        return reader.ReadDouble();
+    case Tag::STRING:
+        return std::string(reader.ReadString());
+    case Tag::ARRAY: {
+        json::Array result(reader.ReadSize());
+        for (auto& item : result) {
+            item = DecodeNode(reader, depth + 1);
+        }
+        return result;
+    }
+    case Tag::DICT: {
+        const size_t size = reader.ReadSize();
+        std::vector<json::Dict::value_type> entries;
+        entries.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            std::string key(reader.ReadString());
+            entries.emplace_back(std::move(key), DecodeNode(reader, depth + 1));
+        }
+        try {
+            return json::Dict(std::move(entries));
+        } catch (const std::invalid_argument& e) {
+            throw ProtocolError(e.what());
+        }
+    }
+    }
+    throw ProtocolError("Unknown value tag");
+}
+
+// Номер запроса для кадра с ошибкой; пусто, если его нельзя прочитать
+std::optional<int> PeekRequestId(std::string_view payload) {
+    try {
+        Reader reader(payload);
+        if (reader.ReadByte() >= static_cast<uint8_t>(StatRequestKind::UNKNOWN)) {
+            return std::nullopt;
+        }
+        return reader.ReadInt();
+    } catch (const ProtocolError&) {
+        return std::nullopt;
+    }
+}
+
+json::Node MakeErrorResponse(std::string_view payload, const char* message) {
+    json::Dict result;
+    if (const auto id = PeekRequestId(payload)) {
+        result.emplace("request_id", *id);
+    }
+    result.emplace("error_message", std::string(message));
+    return result;
+}
+
+} // namespace
+
+bool ReadFrame(std::istream& input, std::string& payload) {
+    uint64_t size = 0;
+    for (int shift = 0;; shift += 7) {
+        const int c = input.get();
+        if (c == std::char_traits<char>::eof()) {
+            if (shift == 0) {
+                return false;
+            }
+            throw ProtocolError("Unexpected end of stream in frame length");
+        }
+        if (shift >= 64) {
+            throw ProtocolError("Frame length is too long");
+        }
+        size |= uint64_t{static_cast<uint8_t>(c) & 0x7Fu} << shift;
+        if ((c & 0x80) == 0) {
+            break;
+        }
+    }
+    if (size > MAX_FRAME_SIZE) {
+        throw ProtocolError("Frame length exceeds limit");
+    }
+    // Читаем частями, чтобы обрезанный поток не заставлял выделять память под всю заявленную длину
+    constexpr size_t CHUNK_SIZE = 64 * 1024;
+    payload.clear();
+    while (payload.size() < size) {
+        const size_t offset = payload.size();
+        const size_t chunk = std::min<size_t>(CHUNK_SIZE, static_cast<size_t>(size) - offset);
+        payload.resize(offset + chunk);
+        if (!input.read(payload.data() + offset, static_cast<std::streamsize>(chunk))) {
+            throw ProtocolError("Unexpected end of stream in frame");
+        }
+    }
+    return true;
+}
+
+void WriteFrame(std::ostream& output, std::string_view payload) {
+    std::string header;
+    WriteVarint(payload.size(), header);
+    output.write(header.data(), static_cast<std::streamsize>(header.size()));
+    output.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+}
+
+void EncodeStatRequest(const StatRequest& request, std::string& payload) {
+    payload.push_back(static_cast<char>(request.kind));
+    WriteSigned(request.id, payload);
+    switch (request.kind) {
+    case StatRequestKind::STOP:
+        WriteObjectId(request.from, payload);
+        break;
+    case StatRequestKind::BUS:
+        WriteObjectId(request.bus, payload);
+        break;
+    case StatRequestKind::ROUTE:
+        WriteObjectId(request.from, payload);
+        WriteObjectId(request.to, payload);
+        payload.push_back(request.pareto ? 1 : 0);
+        break;
+    case StatRequestKind::ROUTE_MATRIX:
+        WriteVarint(request.from_count, payload);
+        WriteVarint(request.matrix_stops.size() - request.from_count, payload);
+        for (const auto* stop : request.matrix_stops) {
+            WriteObjectId(stop, payload);
+        }
+        break;
+    case StatRequestKind::ISOCHRONE:
+        WriteObjectId(request.from, payload);
+        WriteDouble(request.time, payload);
+        payload.push_back(request.render_map ? 1 : 0);
+        break;
+    case StatRequestKind::NEAREST_STOPS:
+        WriteDouble(request.min_coordinates.lat, payload);
+        WriteDouble(request.min_coordinates.lng, payload);
+        payload.push_back(static_cast<char>((request.count ? 1 : 0) | (request.radius ? 2 : 0)));
+        if (request.count) {
+            WriteVarint(*request.count, payload);
+        }
+        if (request.radius) {
+            WriteDouble(*request.radius, payload);
+        }
+        break;
+    case StatRequestKind::STOPS_IN_AREA:
+        WriteDouble(request.min_coordinates.lat, payload);
+        WriteDouble(request.min_coordinates.lng, payload);
+        WriteDouble(request.max_coordinates.lat, payload);
+        WriteDouble(request.max_coordinates.lng, payload);
+        break;
+    case StatRequestKind::AUTOCOMPLETE:
+        WriteVarint(request.limit, payload);
+        if (!request.name_kind) {
+            payload.push_back(0);
+        } else {
+            payload.push_back(*request.name_kind == transport::NameKind::STOP ? 1 : 2);
+        }
+        WriteBytes(request.prefix, payload);
+        break;
+    case StatRequestKind::EARLIEST_ARRIVAL:
+        WriteObjectId(request.from, payload);
+        WriteObjectId(request.to, payload);
+        WriteDouble(request.time, payload);
+        break;
+    case StatRequestKind::MAP:
+    case StatRequestKind::UNKNOWN:
+        break;
+    }
+}
+
+StatRequest DecodeStatRequest(std::string_view payload, const RequestHandler& rh) {
+    Reader reader(payload);
+    StatRequest request;
+    const uint8_t kind = reader.ReadByte();
+    if (kind >= static_cast<uint8_t>(StatRequestKind::UNKNOWN)) {
+        // Запросы неизвестного вида пропускаются, как и в JSON
+        return request;
+    }
+    request.kind = static_cast<StatRequestKind>(kind);
+    request.id = reader.ReadInt();
+    switch (request.kind) {
+    case StatRequestKind::STOP:
+        request.from = ReadStop(reader, rh);
+        break;
+    case StatRequestKind::BUS:
+        request.bus = ReadBus(reader, rh);
+        break;
+    case StatRequestKind::ROUTE:
+        request.from = ReadStop(reader, rh);
+        request.to = ReadStop(reader, rh);
+        request.pareto = (reader.ReadByte() & 1) != 0;
+        break;
+    case StatRequestKind::ROUTE_MATRIX: {
+        request.from_count = reader.ReadSize();
+        const size_t to_count = reader.ReadSize();
+        request.matrix_stops.reserve(request.from_count + to_count);
+        for (size_t i = 0; i < request.from_count + to_count; ++i) {
+            request.matrix_stops.push_back(ReadStop(reader, rh));
+        }
+        break;
+    }
+    case StatRequestKind::ISOCHRONE:
+        request.from = ReadStop(reader, rh);
+        request.time = reader.ReadDouble();
+        if (!std::isfinite(request.time) || request.time < 0.0) {
+            throw ProtocolError("Isochrone requires non-negative max_time");
+        }
+        request.render_map = (reader.ReadByte() & 1) != 0;
+        break;
+    case StatRequestKind::NEAREST_STOPS: {
+        request.min_coordinates.lat = reader.ReadDouble();
+        request.min_coordinates.lng = reader.ReadDouble();
+        const uint8_t flags = reader.ReadByte();
+        if (flags & 1) {
+            request.count = static_cast<size_t>(reader.ReadVarint());
+        }
+        if (flags & 2) {
+            request.radius = reader.ReadDouble();
+        }
+        if (!request.count && !request.radius) {
+            throw ProtocolError("NearestStops requires count or radius");
+        }
+        break;
+    }
+    case StatRequestKind::STOPS_IN_AREA:
+        request.min_coordinates.lat = reader.ReadDouble();
+        request.min_coordinates.lng = reader.ReadDouble();
+        request.max_coordinates.lat = reader.ReadDouble();
+        request.max_coordinates.lng = reader.ReadDouble();
+        break;
+    case StatRequestKind::AUTOCOMPLETE:
+        request.limit = static_cast<size_t>(reader.ReadVarint());
+        switch (reader.ReadByte()) {
+        case 0:
+            break;
+        case 1:
+            request.name_kind = transport::NameKind::STOP;
+            break;
+        case 2:
+            request.name_kind = transport::NameKind::BUS;
+            break;
+        default:
+            throw ProtocolError("Unsupported autocomplete kind");
+        }
+        request.prefix = reader.ReadBytes();
+        break;
+    case StatRequestKind::EARLIEST_ARRIVAL:
+        request.from = ReadStop(reader, rh);
+        request.to = ReadStop(reader, rh);
+        request.time = reader.ReadDouble();
+        break;
+    case StatRequestKind::MAP:
+    case StatRequestKind::UNKNOWN:
+        break;
+    }
+    reader.ExpectEnd();
+    return request;
+}
+
+void EncodeResponse(const json::Node& response, std::string& payload) {
+    EncodeNode(response, payload);
+}
+
+json::Node DecodeResponse(std::string_view payload) {
+    Reader reader(payload);
+    json::Node result = DecodeNode(reader);
+    reader.ExpectEnd();
+    return result;
+}
+
+size_t ServeStatRequests(std::istream& input, std::ostream& output, const JsonReader& reader, RequestHandler& rh) {
+    std::string request_payload;
+    std::string response_payload;
+    size_t count = 0;
+    try {
+        while (ReadFrame(input, request_payload)) {
+            response_payload.clear();
+            // Ошибка в содержимом кадра не мешает читать следующие кадры: отвечаем на неё кадром с error_message
+            try {
+                const StatRequest request = DecodeStatRequest(request_payload, rh);
+                EncodeResponse(reader.HandleStatRequest(request, rh), response_payload);
+            } catch (const std::exception& e) {
+                response_payload.clear();
+                EncodeResponse(MakeErrorResponse(request_payload, e.what()), response_payload);
+            }
+            WriteFrame(output, response_payload);
+            ++count;
+        }
+    } catch (const ProtocolError&) {
+        // Нарушено само деление на кадры: дальше читать нельзя, но готовые ответы должны дойти
+        output.flush();
+        throw;
+    }
+    output.flush();
+    return count;
+}
+
+} // namespace wire
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "json.h"
+#include "json_reader.h"
+#include "request_handler.h"
+#include "stat_request.h"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Двоичный протокол stat_requests. Поток состоит из кадров: длина содержимого (varint) и содержимое.
+// Целые числа записываются как varint (LEB128), знаковые — после zigzag, вещественные — 8 байт IEEE 754
+// в порядке little-endian. Остановки и маршруты задаются номерами Stop::id и Bus::id, увеличенными на 1;
+// 0 — объекта нет в каталоге, ответ на такой запрос — "not found".
+//
+// Запрос: байт StatRequestKind, id, затем поля вида запроса:
+//   Stop — остановка; Bus — маршрут; Map — ничего;
+//   Route — from, to, флаги (бит 0 — pareto);
+//   RouteMatrix — число строк, число столбцов, остановки строк и столбцов;
+//   Isochrone — from, max_time, флаги (бит 0 — render_map);
+//   NearestStops — latitude, longitude, флаги (бит 0 — есть count, бит 1 — есть radius), count, radius;
+//   StopsInArea — min_latitude, min_longitude, max_latitude, max_longitude;
+//   Autocomplete — limit, kind (0 — любой, 1 — Stop, 2 — Bus), prefix (длина и байты);
+//   EarliestArrival — from, to, departure_time.
+//
+// Ответ — тот же json::Node, что и в JSON-выводе, в виде тегированного значения. Ключи словарей
+// и строки из фиксированной таблицы (request_id, total_time, "bus" и т. п.) передаются её номером.
+// На каждый кадр запроса приходит ровно один кадр ответа; ответ на запрос неизвестного вида — null.
+// Если содержимое кадра запроса нарушает формат, ответ — словарь с error_message и, если его удалось
+// прочитать, request_id
+namespace wire {
+
+class ProtocolError : public std::runtime_error {
+public:
+    using runtime_error::runtime_error;
+};
+
+// Кадр длиннее — ошибка протокола: длина приходит извне и не должна вызывать выделение произвольной памяти
+constexpr size_t MAX_FRAME_SIZE = 64 * 1024 * 1024;
+
+// false, если поток закончился до начала кадра
+bool ReadFrame(std::istream& input, std::string& payload);
+void WriteFrame(std::ostream& output, std::string_view payload);
+
+// Дописывают содержимое кадра в конец payload
+void EncodeStatRequest(const StatRequest& request, std::string& payload);
+void EncodeResponse(const json::Node& response, std::string& payload);
+
+// prefix запроса Autocomplete указывает в payload
+StatRequest DecodeStatRequest(std::string_view payload, const RequestHandler& rh);
+json::Node DecodeResponse(std::string_view payload);
+
+// Отвечает на кадры запросов из input кадрами ответов в output; возвращает число запросов.
+// Если нарушено деление на кадры, сбрасывает уже записанные ответы в output и бросает ProtocolError
+size_t ServeStatRequests(std::istream& input, std::ostream& output, const JsonReader& reader, RequestHandler& rh);
+
+} // namespace wire